@@ -2,6 +2,26 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <tuple>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <utility>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <string>
+#include <fstream>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 #include <SFML/Window.hpp>
 #include <SFML/Graphics.hpp>
 #include "SelbaWard/Line.hpp"
@@ -9,8 +29,33 @@ using namespace std;
 
 enum NodeState { Empty = 0, Visited = 1, Junction = 2, Obstacle = 3, Start = 4, End = 5, Path = 6 };
 
+/**
+ * @brief Hands out the (index, weight) pairs of an adjacency list with the weight multiplied by the cost of the neighbor.
+ */
+struct GraphNeighborIterator {
+    vector<pair<int, int>>::const_iterator edge;
+    const int* cost;
+    pair<int, int> operator*() const { return { edge->first, edge->second * cost[edge->first] }; }
+    GraphNeighborIterator& operator++() {
+        ++edge;
+        return *this;
+    }
+    bool operator!=(const GraphNeighborIterator& Other) const { return edge != Other.edge; }
+};
+
+struct GraphNeighborRange {
+    GraphNeighborIterator first, last;
+    GraphNeighborIterator begin() const { return first; }
+    GraphNeighborIterator end() const { return last; }
+};
+
+/**
+ * @brief Graph stored as adjacency lists.
+ * Going over an edge into a node costs the weight of the edge times the cost of that node, so making a node a junction is one store in cost.
+ */
 struct Graph {
     vector<vector<pair<int, int>>>adj_weighted; // First int holds the index of the neighbor, the other int holds the weight between the node and its neighbor
+    vector<int>cost; // Cost of entering every node, 1 for normal nodes, 2 for junctions
     vector<int>parent;
     vector<NodeState>state;
     vector<int>distance; // Distance of every node from the start node
@@ -20,6 +65,7 @@ struct Graph {
      */
     void clear() {
         adj_weighted.clear();
+        cost.clear();
         parent.clear();
         state.clear();
         distance.clear();
@@ -36,56 +82,421 @@ struct Graph {
         adj_weighted[Node1].push_back({ Node2, Weight });
         adj_weighted[Node2].push_back({ Node1, Weight });
     }
-    // This function is written by the devil himself XD
-    void update_node_weight(int Node, int Weight, int SourceNode = -1) {
-        for (pair<int, int>& Nodes : adj_weighted[Node]) {
-            // If we try to update with the same weight nothing will happen
-            if (Nodes.second == Weight)
-                continue;
-            if (SourceNode == -1) {
-                // Update the weight of the node
-                Nodes = { Nodes.first, Weight };
-                // call the function again to update the weight for the side (other neighbor/adjacent)
-                update_node_weight(Nodes.first, Weight, Node);
+    /**
+     * @brief Makes room for NodeCount nodes without any edges, every node costs 1.
+     */
+    void resize(int NodeCount) {
+        clear();
+        adj_weighted.resize(NodeCount);
+        cost.resize(NodeCount, 1);
+        state.resize(NodeCount);
+        parent.resize(NodeCount);
+        distance.resize(NodeCount, 0x7FFFFFFF);
+    }
+    /**
+     * @brief Changes the cost of entering Node, every edge into it follows automatically.
+     */
+    void update_node_weight(int Node, int Weight) {
+        cost[Node] = Weight;
+    }
+    int node_cost(int Node) const {
+        return cost[Node];
+    }
+    /**
+     * @brief Neighbors of a node as (index, weight) pairs, the search functions only go through this.
+     */
+    GraphNeighborRange adjacent(int Node) const {
+        return { { adj_weighted[Node].begin(), cost.data() }, { adj_weighted[Node].end(), cost.data() } };
+    }
+};
+
+/**
+ * @brief Walks two parallel arrays (neighbor index and weight) and hands out (index, weight) pairs like the adjacency lists do.
+ */
+struct CsrNeighborIterator {
+    const int* node;
+    const int* weight;
+    const int* cost;
+    pair<int, int> operator*() const { return { *node, *weight * cost[*node] }; }
+    CsrNeighborIterator& operator++() {
+        ++node;
+        ++weight;
+        return *this;
+    }
+    bool operator!=(const CsrNeighborIterator& Other) const { return node != Other.node; }
+};
+
+struct CsrNeighborRange {
+    CsrNeighborIterator first, last;
+    CsrNeighborIterator begin() const { return first; }
+    CsrNeighborIterator end() const { return last; }
+    size_t size() const { return last.node - first.node; }
+};
+
+/**
+ * @brief Compressed sparse row version of Graph.
+ * All the neighbors are stored back to back in one array, the neighbors of node i are in [adj_offsets[i], adj_offsets[i + 1]).
+ * No allocation per node and the neighbor scan of BFS/Dijkstra/DFS reads memory in order.
+ */
+struct CsrGraph {
+    vector<int>adj_offsets; // size is number of nodes + 1
+    vector<int>adj_nodes; // index of the neighbor
+    vector<int>adj_weights; // weight of the edge, same position as in adj_nodes
+    vector<int>cost; // Cost of entering every node, multiplies the weight of the edges into it like in Graph
+    vector<int>parent;
+    vector<NodeState>state;
+    vector<int>distance; // Distance of every node from the start node
+    int found = 0;
+    /**
+     * @brief Resets the Graph.
+     */
+    void clear() {
+        adj_offsets.clear();
+        adj_nodes.clear();
+        adj_weights.clear();
+        cost.clear();
+        parent.clear();
+        state.clear();
+        distance.clear();
+        found = 0;
+    }
+    /**
+     * @brief Builds the compressed arrays from the adjacency lists of a Graph in one go, the node states are copied too.
+     *
+     * @param graph Graph with its adjacency lists filled. It can be cleared afterwards to free its memory.
+     */
+    void build(const Graph& graph) {
+        const int NodeCount = (int)graph.adj_weighted.size();
+        clear();
+        adj_offsets.resize(NodeCount + 1);
+        adj_offsets[0] = 0;
+        for (int Node = 0; Node < NodeCount; Node++)
+            adj_offsets[Node + 1] = adj_offsets[Node] + (int)graph.adj_weighted[Node].size();
+
+        adj_nodes.resize(adj_offsets[NodeCount]);
+        adj_weights.resize(adj_offsets[NodeCount]);
+        for (int Node = 0; Node < NodeCount; Node++) {
+            int Position = adj_offsets[Node];
+            for (const pair<int, int>& NodeAndWeight : graph.adj_weighted[Node]) {
+                adj_nodes[Position] = NodeAndWeight.first;
+                adj_weights[Position] = NodeAndWeight.second;
+                Position++;
             }
-            // this will update the weight for the other neighbor/adjacent 
-            if (Nodes.first == SourceNode)
-                Nodes = { Nodes.first, Weight };
         }
+
+        cost = graph.cost;
+        cost.resize(NodeCount, 1);
+        state = graph.state;
+        state.resize(NodeCount, Empty);
+        parent.resize(NodeCount);
+        distance.resize(NodeCount, 0x7FFFFFFF);
+    }
+    /**
+     * @brief Same as Graph::update_node_weight, changes the cost of entering Node.
+     */
+    void update_node_weight(int Node, int Weight) {
+        cost[Node] = Weight;
+    }
+    int node_cost(int Node) const {
+        return cost[Node];
+    }
+    CsrNeighborRange adjacent(int Node) const {
+        return { { adj_nodes.data() + adj_offsets[Node], adj_weights.data() + adj_offsets[Node], cost.data() },
+                 { adj_nodes.data() + adj_offsets[Node + 1], adj_weights.data() + adj_offsets[Node + 1], cost.data() } };
+    }
+};
+
+
+struct GridMap;
+
+/**
+ * @brief Hands out the up, down, left, right neighbors of a cell (same order the World used to add its edges), skipping the ones outside the grid.
+ */
+struct GridNeighborIterator {
+    const GridMap* grid;
+    int node;
+    int direction; // 0 up, 1 down, 2 left, 3 right, 4 end
+    inline pair<int, int> operator*() const;
+    inline GridNeighborIterator& operator++();
+    bool operator!=(const GridNeighborIterator& Other) const { return direction != Other.direction; }
+    inline void skip_outside();
+};
+
+struct GridNeighborRange {
+    GridNeighborIterator first, last;
+    GridNeighborIterator begin() const { return first; }
+    GridNeighborIterator end() const { return last; }
+};
+
+/**
+ * @brief The map part of a grid: size, what every cell is and what it costs, without any search state.
+ * The edges aren't stored, the neighbors of a node come from y * width + x and going into a cell costs the cost of that cell.
+ * The Search* functions only read it, so one map can answer queries from several threads at once, each thread with its own SearchContext.
+ * The in-place engines (BreadthFirstSearch, DijkstraQ, ...) on a GridGraph still write Visited and Path into state, so they must not
+ * run on a map that is being shared.
+ */
+struct GridMap {
+    int width = 0;
+    int height = 0;
+    vector<unsigned char>cost; // Weight of every cell, 1 for normal cells, 2 for junctions
+    vector<NodeState>state; // Empty, Junction, Obstacle, Start or End (the in-place engines on a GridGraph also write Visited and Path here)
+    /**
+     * @brief Makes an empty Width x Height grid where every cell costs 1.
+     */
+    void resize(int Width, int Height) {
+        width = Width;
+        height = Height;
+        cost.assign((size_t)width * height, 1);
+        state.assign((size_t)width * height, Empty);
+    }
+    /**
+     * @brief Changes the cost of a cell, every edge touching it follows automatically.
+     *
+     * @param Weight between 1 and 255.
+     */
+    void update_node_weight(int Node, int Weight) {
+        cost[Node] = (unsigned char)Weight;
+    }
+    int node_cost(int Node) const {
+        return cost[Node];
+    }
+    GridNeighborRange adjacent(int Node) const {
+        GridNeighborIterator first = { this, Node, 0 };
+        first.skip_outside();
+        return { first, { this, Node, 4 } };
+    }
+};
+
+/**
+ * @brief Grid graph that doesn't store any edges, a GridMap plus the search state the searches like BreadthFirstSearch write in.
+ */
+struct GridGraph : GridMap {
+    vector<int>parent;
+    vector<int>distance; // Distance of every node from the start node
+    int found = 0;
+    /**
+     * @brief Resets the Graph.
+     */
+    void clear() {
+        width = height = 0;
+        cost.clear();
+        parent.clear();
+        state.clear();
+        distance.clear();
+        found = 0;
+    }
+    /**
+     * @brief Makes an empty Width x Height grid where every cell costs 1.
+     */
+    void resize(int Width, int Height) {
+        clear();
+        GridMap::resize(Width, Height);
+        parent.resize((size_t)width * height);
+        distance.resize((size_t)width * height, 0x7FFFFFFF);
+    }
+};
+
+pair<int, int> GridNeighborIterator::operator*() const {
+    int Neighbor = node;
+    switch (direction) {
+    case 0: Neighbor -= grid->width; break;
+    case 1: Neighbor += grid->width; break;
+    case 2: Neighbor -= 1; break;
+    default: Neighbor += 1; break;
+    }
+    return { Neighbor, grid->cost[Neighbor] };
+}
+
+GridNeighborIterator& GridNeighborIterator::operator++() {
+    direction++;
+    skip_outside();
+    return *this;
+}
+
+void GridNeighborIterator::skip_outside() {
+    int x = node % grid->width;
+    int y = node / grid->width;
+    // Boundery checks
+    while ((direction == 0 && y == 0) || (direction == 1 && y == grid->height - 1) ||
+           (direction == 2 && x == 0) || (direction == 3 && x == grid->width - 1))
+        direction++;
+}
+
+struct DiagonalGridGraph;
+
+/**
+ * @brief Hands out the 8 neighbors of a cell: up, down, left, right, then up-left, up-right, down-left, down-right.
+ * A diagonal step is left out when it would cut the corner of an obstacle (see DiagonalGridGraph::cut_corners).
+ */
+struct DiagonalNeighborIterator {
+    const DiagonalGridGraph* grid;
+    int node;
+    int direction; // 0 to 7, 8 end
+    inline pair<int, int> operator*() const;
+    inline DiagonalNeighborIterator& operator++();
+    bool operator!=(const DiagonalNeighborIterator& Other) const { return direction != Other.direction; }
+    inline void skip_blocked();
+};
+
+struct DiagonalNeighborRange {
+    DiagonalNeighborIterator first, last;
+    DiagonalNeighborIterator begin() const { return first; }
+    DiagonalNeighborIterator end() const { return last; }
+};
+
+/**
+ * @brief A GridGraph seen as an 8-connected grid, every search template runs on it unchanged.
+ * It keeps references to the grid's arrays, so whatever a search writes (state, parent, distance, found) lands in the GridGraph.
+ * Steps cost Straight or Diagonal (10 and 14, octile costs in tenths of a cell) times the cost of the cell entered, use
+ * OctileHeuristic{ width, Straight, Diagonal } with it. A diagonal step never goes between two obstacles, and only past one if cut_corners.
+ */
+struct DiagonalGridGraph {
+    static const int Straight = 10;
+    static const int Diagonal = 14;
+    GridGraph& grid;
+    vector<NodeState>& state;
+    vector<int>& parent;
+    vector<int>& distance;
+    int& found;
+    int width;
+    int height;
+    bool cut_corners;
+    DiagonalGridGraph(GridGraph& Grid, bool CutCorners = false)
+        : grid(Grid), state(Grid.state), parent(Grid.parent), distance(Grid.distance), found(Grid.found), width(Grid.width), height(Grid.height), cut_corners(CutCorners) {}
+    int node_cost(int Node) const {
+        return grid.cost[Node];
+    }
+    DiagonalNeighborRange adjacent(int Node) const {
+        DiagonalNeighborIterator first = { this, Node, 0 };
+        first.skip_blocked();
+        return { first, { this, Node, 8 } };
     }
 };
+const int DiagonalGridGraph::Straight;
+const int DiagonalGridGraph::Diagonal;
+
+pair<int, int> DiagonalNeighborIterator::operator*() const {
+    const int dx[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    const int dy[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    int Neighbor = node + dy[direction] * grid->width + dx[direction];
+    return { Neighbor, (direction < 4 ? DiagonalGridGraph::Straight : DiagonalGridGraph::Diagonal) * grid->grid.cost[Neighbor] };
+}
 
+DiagonalNeighborIterator& DiagonalNeighborIterator::operator++() {
+    direction++;
+    skip_blocked();
+    return *this;
+}
+
+void DiagonalNeighborIterator::skip_blocked() {
+    const int dx[8] = { 0, 0, -1, 1, -1, 1, -1, 1 };
+    const int dy[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+    int x = node % grid->width;
+    int y = node / grid->width;
+    for (; direction < 8; direction++) {
+        int nx = x + dx[direction], ny = y + dy[direction];
+        if (nx < 0 || ny < 0 || nx >= grid->width || ny >= grid->height)
+            continue;
+        if (direction < 4)
+            break;
+        // The two cells beside a diagonal step
+        int Open = (grid->state[y * grid->width + nx] != Obstacle) + (grid->state[ny * grid->width + x] != Obstacle);
+        if (Open == 2 || (Open == 1 && grid->cut_corners))
+            break;
+    }
+}
 
 /**
  * @brief DFS implementation using recursion.
  *
- * @param graph Initialized graph that must not have been used.
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
  * @param Node Starting Node for DFS to be used.
  * @param PreviousNode Parent of the starting node, if the graph is a tree and the node is the root, the parent will be -1. That if it is acyclic, for cyclic, it will be the node itself.
  */
-void DepthFirstSearch(Graph& graph, int Node, int EndNode, int Parent = -1) {
+template <typename GraphType>
+void DepthFirstSearch(GraphType& graph, int Node, int EndNode, int Parent = -1) {
     graph.state[Node] = Visited;
     graph.parent[Node] = Parent; // Change to Node if the graph is cyclic.
     if (Node == EndNode) {
         graph.found = 1;
         return;
     }
-    for (int i = 0; i < graph.adj_weighted[Node].size(); i++) {
+    for (pair<int, int> NodeAndWeight : graph.adjacent(Node)) {
         if (graph.found)
             break;
-        int NodeState = graph.state[graph.adj_weighted[Node][i].first];
+        int NodeState = graph.state[NodeAndWeight.first];
         if (NodeState == Empty || NodeState == Junction || NodeState == End)
-            DepthFirstSearch(graph, graph.adj_weighted[Node][i].first, EndNode, Node);
+            DepthFirstSearch(graph, NodeAndWeight.first, EndNode, Node);
+    }
+}
+
+/**
+ * @brief The explicit stack of DepthFirstSearchIterative, one frame per node on the current DFS path.
+ * Keep one around and pass it to every search, after the first deep search it doesn't allocate anymore.
+ */
+template <typename GraphType>
+struct DepthFirstStack {
+    typedef decltype(declval<const GraphType&>().adjacent(0).begin()) Iterator;
+    struct Frame {
+        int node;
+        Iterator next; // Next neighbor to look at
+        Iterator last;
+    };
+    vector<Frame>frames;
+};
+
+/**
+ * @brief DFS with an explicit stack instead of recursion, so a long corridor can't overflow the thread stack.
+ * Visits the nodes in the same order as DepthFirstSearch and leaves the same parent and found.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param Source Starting Node for DFS to be used.
+ * @param stack Storage for the stack, reused between searches.
+ */
+template <typename GraphType>
+void DepthFirstSearchIterative(GraphType& graph, int Source, int EndNode, DepthFirstStack<GraphType>& stack, int Parent = -1) {
+    typedef typename DepthFirstStack<GraphType>::Frame Frame;
+    stack.frames.clear();
+    graph.state[Source] = Visited;
+    graph.parent[Source] = Parent;
+    if (Source == EndNode) {
+        graph.found = 1;
+        return;
+    }
+    Frame First = { Source, graph.adjacent(Source).begin(), graph.adjacent(Source).end() };
+    stack.frames.push_back(First);
+
+    while (!stack.frames.empty()) {
+        Frame& top = stack.frames.back();
+        // All neighbors done, return to the parent
+        if (!(top.next != top.last)) {
+            stack.frames.pop_back();
+            continue;
+        }
+        int Node = (*top.next).first;
+        ++top.next;
+        int NodeState = graph.state[Node];
+        if (NodeState == Empty || NodeState == Junction || NodeState == End) {
+            graph.state[Node] = Visited;
+            graph.parent[Node] = top.node;
+            if (Node == EndNode) {
+                graph.found = 1;
+                return;
+            }
+            Frame Next = { Node, graph.adjacent(Node).begin(), graph.adjacent(Node).end() };
+            stack.frames.push_back(Next);
+        }
     }
 }
 
 /**
  * @brief A BFS implementation using a queue to simulate recursion and save memory on stack frames.
  *
- * @param graph Initialized graph that must not have been used.
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
  * @param Source A source node to start BFS from.
  */
-void BreadthFirstSearch(Graph& graph, int Source, int EndNode, int Parent = -1) {
+template <typename GraphType>
+void BreadthFirstSearch(GraphType& graph, int Source, int EndNode, int Parent = -1) {
     queue<int>que;
     que.push(Source);
     if (graph.state[Source] != Start)
@@ -99,7 +510,7 @@ void BreadthFirstSearch(Graph& graph, int Source, int EndNode, int Parent = -1)
             graph.found = 1;
             break;
         }
-        for (pair<int, int> NodeAndWeight : graph.adj_weighted[Parent]) {
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
             int Node = NodeAndWeight.first;
             int Weight = NodeAndWeight.second;
             if (graph.state[Node] != Obstacle && graph.state[Node] != Visited && graph.state[Node] != Start) { // If we haven't visited this node,
@@ -112,7 +523,8 @@ void BreadthFirstSearch(Graph& graph, int Source, int EndNode, int Parent = -1)
     }
 }
 
-void DijkstraQ(Graph& graph, int Source, int EndNode, int Parent = -1) {
+template <typename GraphType>
+void DijkstraQ(GraphType& graph, int Source, int EndNode, int Parent = -1) {
     // first pair is distance second is index
     typedef pair<int, int> pairOfInt;    
     priority_queue<pairOfInt, vector<pairOfInt>, greater<pairOfInt>>que; // vector and greater parameter are for reversing the priority (min heap)
@@ -128,7 +540,7 @@ void DijkstraQ(Graph& graph, int Source, int EndNode, int Parent = -1) {
             break;
         }
         que.pop();
-        for (pair<int, int> NodeAndWeight : graph.adj_weighted[Parent]) {
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
             int Node = NodeAndWeight.first;
             int Weight = NodeAndWeight.second;
             if (graph.state[Node] != Obstacle && graph.state[Node] != Start) { // If we haven't visited this node,
@@ -148,146 +560,3677 @@ void DijkstraQ(Graph& graph, int Source, int EndNode, int Parent = -1) {
 
 
 /**
- * @brief Get you the path whether you ran BFS, DFS or Dijkstra on the graph.
+ * @brief Dijkstra with a bucket queue (Dial's algorithm) instead of a heap, for small integer weights.
+ * Bucket d % (MaxWeight + 1) holds the nodes at distance d, so there are only MaxWeight + 1 buckets and they are reused in a circle.
+ * Nodes in the same bucket are taken in index order, the same order the pairs come out of DijkstraQ's heap, so distance and parent end up the same as DijkstraQ.
  *
- * @param graph Initialized Graph that have been used.
- * @param DestinationNode The end node of the path you want to get from the start node. The start node must have been used in the initial BFS, DFS, Dijkstra arguments.
- * @return vector<int> Path from source node to destination node, If there isn't a path, check if `path.size() == 0 || path[path.size()-1] != SourceNode` afterwards.
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param Source A source node to start from.
+ * @param MaxWeight The biggest weight of any edge in the graph (2 when there are junctions), all weights must be at least 1.
  */
-vector<int> GetPath(Graph& graph, const int DestinationNode, const int SourceNode = -1) {
-    vector<int> path;
-    for (int Node = DestinationNode; Node != SourceNode; Node = graph.parent[Node], graph.state[Node] = Path)
-        path.push_back(Node);
-    graph.state[SourceNode] = Start;
-    graph.state[DestinationNode] = End;
-    reverse(path.begin(), path.end());
-    return path;
+template <typename GraphType>
+void DijkstraDial(GraphType& graph, int Source, int EndNode, int MaxWeight, int Parent = -1) {
+    vector<vector<int>>buckets(MaxWeight + 1);
+    buckets[0].push_back(Source);
+    int Pending = 1; // Number of nodes in all the buckets
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+
+    for (int Distance = 0; Pending > 0; Distance++) {
+        vector<int>& bucket = buckets[Distance % (MaxWeight + 1)];
+        if (bucket.empty())
+            continue;
+        // Nothing can be added to this bucket anymore (weights are at least 1), so it can be put in order now
+        sort(bucket.begin(), bucket.end());
+        for (int Current : bucket) {
+            // Got a shorter distance after it was put here
+            if (graph.distance[Current] != Distance)
+                continue;
+            if (Current == EndNode) {
+                graph.found = 1;
+                return;
+            }
+            for (pair<int, int> NodeAndWeight : graph.adjacent(Current)) {
+                int Node = NodeAndWeight.first;
+                int Weight = NodeAndWeight.second;
+                if (graph.state[Node] != Obstacle && graph.state[Node] != Start) {
+                    graph.state[Node] = Visited;
+
+                    int NetWeight = Distance + Weight;
+                    if (NetWeight < graph.distance[Node]) {
+                        graph.distance[Node] = NetWeight;
+                        graph.parent[Node] = Current;
+                        buckets[NetWeight % (MaxWeight + 1)].push_back(Node);
+                        Pending++;
+                    }
+                }
+            }
+        }
+        Pending -= (int)bucket.size();
+        bucket.clear();
+    }
 }
 
-struct World {
-    int worldHeight;
-    int worldWidth;
-    int cellWidth;
-    int startIndex = -1, endIndex = -1;
-    sf::Vector2u windowSize;
-    std::vector<sw::Line> grid;
-    Graph graph;
-    int mode = 0;
+/**
+ * @brief Number of bits needed to write Value (0 for 0), the bucket index of the radix heap.
+ */
+inline int BitLength(unsigned long long Value) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long Index;
+    return _BitScanReverse64(&Index, Value) ? (int)Index + 1 : 0;
+#elif defined(__GNUC__)
+    return Value ? 64 - __builtin_clzll(Value) : 0;
+#else
+    int Length = 0;
+    for (; Value; Value >>= 1)
+        Length++;
+    return Length;
+#endif
+}
 
-    bool once = true;
+/**
+ * @brief Index of the lowest set bit of Value, Value must not be 0.
+ */
+inline int TrailingZeros(unsigned long long Value) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long Index;
+    _BitScanForward64(&Index, Value);
+    return (int)Index;
+#elif defined(__GNUC__)
+    return __builtin_ctzll(Value);
+#else
+    int Index = 0;
+    for (; !(Value & 1); Value >>= 1)
+        Index++;
+    return Index;
+#endif
+}
 
-    // Text
-    sf::Text text;
+/**
+ * @brief Monotone radix heap, a min priority queue for Dijkstra where a pushed key is never smaller than the last popped key.
+ * An entry sits in the bucket of the highest bit where its key differs from the last popped key, so every entry moves down at most once per bit
+ * and push/pop are O(1) amortized per bit of Key instead of O(log n) compares.
+ *
+ * @tparam Key Integer type of the keys (int for the grid weights, long long or unsigned long long for big accumulated costs), keys must not be negative.
+ */
+template <typename Key>
+struct RadixHeap {
+    typedef typename make_unsigned<Key>::type UnsignedKey;
+    static const int Bits = sizeof(Key) * 8;
+    vector<pair<Key, int>>buckets[Bits + 1]; // (key, node)
+    Key last = 0;
+    size_t count = 0;
 
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void clear() {
+        for (int i = 0; i <= Bits; i++)
+            buckets[i].clear();
+        last = 0;
+        count = 0;
+    }
+    void push(Key Priority, int Node) {
+        buckets[BitLength((UnsignedKey)Priority ^ (UnsignedKey)last)].push_back({ Priority, Node });
+        count++;
+    }
+    /**
+     * @brief Smallest entry, call only when not empty. Moves entries between buckets, that's why it isn't const.
+     */
+    const pair<Key, int>& top() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty())
+                i++;
+            // The smallest key of the first used bucket becomes the new reference, everything in that bucket goes down
+            last = buckets[i][0].first;
+            for (const pair<Key, int>& Entry : buckets[i])
+                last = min(last, Entry.first);
+            for (const pair<Key, int>& Entry : buckets[i])
+                buckets[BitLength((UnsignedKey)Entry.first ^ (UnsignedKey)last)].push_back(Entry);
+            buckets[i].clear();
+        }
+        return buckets[0].back();
+    }
+    void pop() {
+        top();
+        buckets[0].pop_back();
+        count--;
+    }
+};
 
-    World(sf::RenderWindow& window, sf::Font& arialFont) {
-        // settings
-        windowSize = window.getSize();
-        cellWidth = 20;
-        worldWidth = windowSize.x / cellWidth;
-        worldHeight = windowSize.y / cellWidth;
+/**
+ * @brief Dijkstra on a radix heap, for weights too spread out for the buckets of DijkstraDial.
+ * The key type is the type of graph.distance, so a graph that keeps 64 bit distances gets a 64 bit heap.
+ * Distances are the same as DijkstraQ, with ties the parent can be a different (just as short) one.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param Source A source node to start from.
+ */
+template <typename GraphType>
+void DijkstraRadix(GraphType& graph, int Source, int EndNode, int Parent = -1) {
+    typedef typename decay<decltype(graph.distance[0])>::type DistanceType;
+    RadixHeap<DistanceType> que;
+    que.push(0, Source);
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
 
-        // Nodes
-        graph.adj_weighted.resize(worldHeight * worldWidth, std::vector<pair<int, int>>());
-        graph.state.resize(worldHeight * worldWidth);
-        graph.parent.resize(worldHeight * worldWidth);
-        graph.distance.resize(worldHeight * worldWidth, 0x7FFFFFFF);
+    while (!que.empty()) {
+        DistanceType Distance = que.top().first;
+        Parent = que.top().second;
+        que.pop();
+        // Got a shorter distance after this entry was pushed
+        if (Distance != graph.distance[Parent])
+            continue;
+        if (Parent == EndNode) {
+            graph.found = 1;
+            break;
+        }
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
+            int Node = NodeAndWeight.first;
+            int Weight = NodeAndWeight.second;
+            if (graph.state[Node] != Obstacle && graph.state[Node] != Start) {
+                graph.state[Node] = Visited;
 
-        // Font and text settinggs
-        text.setFont(arialFont); // font is a sf::Font
-        text.setString("BFS");
-        text.setCharacterSize(24); // in pixels, not points!
-        text.setFillColor(sf::Color::Black);
-        text.setStyle(sf::Text::Bold | sf::Text::Underlined);
-                    
-
-        // Set the nodes settings
-        int count = 0;
-        for (int y = 0; y < worldHeight; y++)
-            for (int x = 0; x < worldWidth; x++) {
-                // Boundery checks before adding neighbors
-                int up = (y - 1) * worldWidth + x;
-                int down = (y + 1) * worldWidth + x;
-                int left = y * worldWidth + (x - 1);
-                int right = y * worldWidth + (x + 1);
-
-                if (y > 0)
-                    graph.adj_weighted[count].push_back({ up,    1 });
-                if (y < worldHeight - 1)
-                    graph.adj_weighted[count].push_back({ down,  1 });
-                if (x > 0)
-                    graph.adj_weighted[count].push_back({ left,  1 });
-                if (x < worldWidth - 1)
-                    graph.adj_weighted[count].push_back({ right, 1 });
-                count++;
+                DistanceType NetWeight = Distance + Weight;
+                if (NetWeight < graph.distance[Node]) {
+                    graph.distance[Node] = NetWeight;
+                    graph.parent[Node] = Parent;
+                    que.push(NetWeight, Node);
+                }
             }
+        }
+    }
+}
 
-        // grid
-        sw::Line line;
-        line.setColor(sf::Color::Black);
+/**
+ * @brief Search state with 64 bit distances over the edges of another graph, for maps where a path can cost more than an int holds.
+ * The other graph is only read, DijkstraRadix on this gets a 64 bit radix heap.
+ */
+template <typename GraphType>
+struct LongDistanceGraph {
+    const GraphType* graph;
+    vector<int>parent;
+    vector<NodeState>state;
+    vector<long long>distance;
+    int found = 0;
 
-        // Horizontal
-        for (int y = 1; y < worldHeight; y++) {
-            line.setPoint(0, sf::Vector2f(0.0f, y * cellWidth));
-            line.setPoint(1, sf::Vector2f(windowSize.x, y * cellWidth));
-            grid.push_back(line);
-        }
-        // Vertical
-        for (int x = 1; x < worldWidth; x++) {
-            line.setPoint(0, sf::Vector2f(x * cellWidth, 0.0f));
-            line.setPoint(1, sf::Vector2f(x * cellWidth, windowSize.y));
-            grid.push_back(line);
-        }
+    explicit LongDistanceGraph(const GraphType& Graph)
+        : graph(&Graph), parent(Graph.state.size()), state(Graph.state), distance(Graph.state.size(), 0x7FFFFFFFFFFFFFFFLL) {}
+    int node_cost(int Node) const {
+        return graph->node_cost(Node);
+    }
+    auto adjacent(int Node) const {
+        return graph->adjacent(Node);
     }
+};
 
-    void update(sf::RenderWindow& window, sf::Event& event) {
-        // Checks for event that chanegs the nodes status
-        updateNodes(window, event);
+/**
+ * @brief Min heap of (key, node) pairs with Arity children per entry that knows where every node is, so a node is in it at most once and its key can be lowered in place.
+ * The 4 children of an entry are next to each other in memory, the heap is half as deep as a binary one.
+ * Pairs are compared like in DijkstraQ's priority_queue, smaller key first and smaller node on equal keys.
+ */
+template <int Arity = 4>
+struct IndexedHeap {
+    vector<pair<int, int>>heap; // (key, node)
+    vector<int>position; // Slot of every node in heap, -1 if the node isn't in it
 
-        // Check if mode is changed
-        if (event.type == sf::Event::KeyPressed)
-            if (event.key.code == sf::Keyboard::LAlt || event.key.code == sf::Keyboard::RAlt) {
-                mode++;
-                mode %= 3;
-                switch (mode) {
-                case 0:
-                    text.setString("BFS");
+    /**
+     * @brief Empties the heap and makes room for NodeCount nodes (graph.state.size()).
+     */
+    void resize(size_t NodeCount) {
+        heap.clear();
+        position.assign(NodeCount, -1);
+    }
+    /**
+     * @brief Empties the heap, only touches the nodes that are still in it.
+     */
+    void clear() {
+        for (const pair<int, int>& Entry : heap)
+            position[Entry.second] = -1;
+        heap.clear();
+    }
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    bool contains(int Node) const { return position[Node] != -1; }
+    const pair<int, int>& top() const { return heap[0]; }
+    /**
+     * @brief Adds Node with Key, or lowers its key if it is already in the heap with a bigger one.
+     */
+    void push_or_decrease(int Key, int Node) {
+        int Slot = position[Node];
+        if (Slot == -1) {
+            heap.push_back({ Key, Node });
+            sift_up((int)heap.size() - 1);
+        }
+        else if (Key < heap[Slot].first) {
+            heap[Slot].first = Key;
+            sift_up(Slot);
+        }
+    }
+    void pop() {
+        position[heap[0].second] = -1;
+        pair<int, int> Last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = Last;
+            sift_down(0);
+        }
+    }
+
+private:
+    void sift_up(int Slot) {
+        pair<int, int> Entry = heap[Slot];
+        while (Slot > 0) {
+            int ParentSlot = (Slot - 1) / Arity;
+            if (!(Entry < heap[ParentSlot]))
+                break;
+            heap[Slot] = heap[ParentSlot];
+            position[heap[Slot].second] = Slot;
+            Slot = ParentSlot;
+        }
+        heap[Slot] = Entry;
+        position[Entry.second] = Slot;
+    }
+    void sift_down(int Slot) {
+        pair<int, int> Entry = heap[Slot];
+        const int Size = (int)heap.size();
+        while (true) {
+            int FirstChild = Slot * Arity + 1;
+            if (FirstChild >= Size)
+                break;
+            int LastChild = min(FirstChild + Arity, Size);
+            int Smallest = FirstChild;
+            for (int Child = FirstChild + 1; Child < LastChild; Child++)
+                if (heap[Child] < heap[Smallest])
+                    Smallest = Child;
+            if (!(heap[Smallest] < Entry))
+                break;
+            heap[Slot] = heap[Smallest];
+            position[heap[Slot].second] = Slot;
+            Slot = Smallest;
+        }
+        heap[Slot] = Entry;
+        position[Entry.second] = Slot;
+    }
+};
+
+/**
+ * @brief Dijkstra on an IndexedHeap, every node is in the queue at most once so it never holds more entries than there are nodes.
+ * Pops in the same order as DijkstraQ, so distance and parent are the same.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param Source A source node to start from.
+ * @param que Heap to use, it is resized to the graph if needed and left empty, so one heap can serve many searches without allocating.
+ */
+template <typename GraphType>
+void DijkstraIndexed(GraphType& graph, int Source, int EndNode, IndexedHeap<4>& que, int Parent = -1) {
+    if (que.position.size() != graph.state.size())
+        que.resize(graph.state.size());
+    que.clear();
+    que.push_or_decrease(0, Source);
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+
+    while (!que.empty()) {
+        Parent = que.top().second;
+        if (Parent == EndNode) {
+            graph.found = 1;
+            break;
+        }
+        que.pop();
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
+            int Node = NodeAndWeight.first;
+            int Weight = NodeAndWeight.second;
+            if (graph.state[Node] != Obstacle && graph.state[Node] != Start) {
+                graph.state[Node] = Visited;
+
+                int NetWeight = graph.distance[Parent] + Weight;
+                if (NetWeight < graph.distance[Node]) {
+                    graph.distance[Node] = NetWeight;
+                    graph.parent[Node] = Parent;
+                    que.push_or_decrease(NetWeight, Node);
+                }
+            }
+        }
+    }
+    que.clear();
+}
+
+/**
+ * @brief Weight of the edge To -> From, given the weight of From -> To. The edge weight is the same both ways, only the cost of the node entered differs.
+ */
+template <typename GraphType>
+int ReverseWeight(const GraphType& graph, int From, int To, int Weight) {
+    return Weight / graph.node_cost(To) * graph.node_cost(From);
+}
+
+/**
+ * @brief Turns the backward half of a bidirectional search around so graph.parent goes from EndNode all the way back to the source.
+ * Only valid if every edge goes both ways, which is the case for all the graphs here.
+ *
+ * @param Meet Node reached by the backward search whose backward parents lead to EndNode.
+ * @param From Node of the forward search next to Meet (Meet itself if both searches reached the same node).
+ */
+template <typename GraphType>
+void JoinBidirectional(GraphType& graph, int From, int Meet, int EndNode, const vector<int>& BackwardParent, const vector<int>& BackwardDistance, int MeetWeight) {
+    if (From != Meet) {
+        graph.parent[Meet] = From;
+        graph.distance[Meet] = graph.distance[From] + MeetWeight;
+    }
+    for (int Node = Meet; Node != EndNode; ) {
+        int Next = BackwardParent[Node];
+        graph.parent[Next] = Node;
+        graph.distance[Next] = graph.distance[Node] + BackwardDistance[Node] - BackwardDistance[Next];
+        Node = Next;
+    }
+    graph.found = 1;
+}
+
+/**
+ * @brief BFS from both ends at once, a whole level of the smaller frontier is expanded each round until the two searches touch.
+ * Finds a path with as few steps as BreadthFirstSearch while exploring about half the radius. graph.parent is joined at the end so GetPath works as usual.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param Source A source node to start from.
+ */
+template <typename GraphType>
+void BidirectionalBFS(GraphType& graph, int Source, int EndNode, int Parent = -1) {
+    const int NodeCount = (int)graph.state.size();
+    vector<int>forwardHops(NodeCount, -1), backwardHops(NodeCount, -1);
+    vector<int>backwardParent(NodeCount, -1), backwardDistance(NodeCount, 0);
+    vector<int>forward(1, Source), backward(1, EndNode), next;
+    forwardHops[Source] = 0;
+    backwardHops[EndNode] = 0;
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+    if (Source == EndNode) {
+        graph.found = 1;
+        return;
+    }
+
+    int BestHops = 0x7FFFFFFF, BestFrom = -1, BestMeet = -1, BestWeight = 0;
+    while (!forward.empty() && !backward.empty() && BestMeet == -1) {
+        bool Forward = forward.size() <= backward.size();
+        vector<int>& frontier = Forward ? forward : backward;
+        vector<int>& hops = Forward ? forwardHops : backwardHops;
+        vector<int>& otherHops = Forward ? backwardHops : forwardHops;
+        next.clear();
+        for (int Current : frontier)
+            for (pair<int, int> NodeAndWeight : graph.adjacent(Current)) {
+                int Node = NodeAndWeight.first;
+                // The backward search walks the edges the other way
+                int Weight = Forward ? NodeAndWeight.second : ReverseWeight(graph, Current, Node, NodeAndWeight.second);
+                if (graph.state[Node] == Obstacle)
+                    continue;
+                // The other search got here, keep the shortest way through this level
+                if (otherHops[Node] != -1) {
+                    int Hops = hops[Current] + 1 + otherHops[Node];
+                    if (Hops < BestHops) {
+                        BestHops = Hops;
+                        BestFrom = Forward ? Current : Node;
+                        BestMeet = Forward ? Node : Current;
+                        BestWeight = Weight;
+                    }
+                }
+                if (hops[Node] != -1)
+                    continue;
+                hops[Node] = hops[Current] + 1;
+                if (graph.state[Node] != Start)
+                    graph.state[Node] = Visited;
+                if (Forward) {
+                    graph.distance[Node] = graph.distance[Current] + Weight;
+                    graph.parent[Node] = Current;
+                }
+                else {
+                    backwardDistance[Node] = backwardDistance[Current] + Weight;
+                    backwardParent[Node] = Current;
+                }
+                next.push_back(Node);
+            }
+        frontier.swap(next);
+    }
+    if (BestMeet != -1)
+        JoinBidirectional(graph, BestFrom, BestMeet, EndNode, backwardParent, backwardDistance, BestWeight);
+}
+
+/**
+ * @brief Dijkstra from both ends at once, each step pops from the queue with the smaller top.
+ * Every edge between the two searches is a candidate path, the search stops once the two tops together can't beat the best candidate
+ * (the tops alone meeting isn't enough with weights). graph.parent is joined at the end so GetPath works as usual.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param Source A source node to start from.
+ */
+template <typename GraphType>
+void BidirectionalDijkstra(GraphType& graph, int Source, int EndNode, int Parent = -1) {
+    typedef pair<int, int> pairOfInt; // (distance, index)
+    const int NodeCount = (int)graph.state.size();
+    vector<int>backwardParent(NodeCount, -1), backwardDistance(NodeCount, 0x7FFFFFFF);
+    priority_queue<pairOfInt, vector<pairOfInt>, greater<pairOfInt>>forward, backward;
+    forward.push(make_pair(0, Source));
+    backward.push(make_pair(0, EndNode));
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+    backwardDistance[EndNode] = 0;
+    if (Source == EndNode) {
+        graph.found = 1;
+        return;
+    }
+
+    long long Best = 0x7FFFFFFF;
+    int BestFrom = -1, BestMeet = -1, BestWeight = 0;
+    while (!forward.empty() && !backward.empty() && (long long)forward.top().first + backward.top().first < Best) {
+        bool Forward = forward.top().first <= backward.top().first;
+        priority_queue<pairOfInt, vector<pairOfInt>, greater<pairOfInt>>& que = Forward ? forward : backward;
+        vector<int>& distance = Forward ? graph.distance : backwardDistance;
+        vector<int>& otherDistance = Forward ? backwardDistance : graph.distance;
+        int Distance = que.top().first;
+        int Current = que.top().second;
+        que.pop();
+        if (Distance != distance[Current])
+            continue;
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Current)) {
+            int Node = NodeAndWeight.first;
+            // The backward search walks the edges the other way
+            int Weight = Forward ? NodeAndWeight.second : ReverseWeight(graph, Current, Node, NodeAndWeight.second);
+            if (graph.state[Node] == Obstacle)
+                continue;
+            if (graph.state[Node] != Start)
+                graph.state[Node] = Visited;
+            int NetWeight = Distance + Weight;
+            if (NetWeight < distance[Node]) {
+                distance[Node] = NetWeight;
+                if (Forward)
+                    graph.parent[Node] = Current;
+                else
+                    backwardParent[Node] = Current;
+                que.push(make_pair(NetWeight, Node));
+            }
+            if (otherDistance[Node] != 0x7FFFFFFF && (long long)NetWeight + otherDistance[Node] < Best) {
+                Best = (long long)NetWeight + otherDistance[Node];
+                BestFrom = Forward ? Current : Node;
+                BestMeet = Forward ? Node : Current;
+                BestWeight = Weight;
+            }
+        }
+    }
+    if (BestMeet != -1)
+        JoinBidirectional(graph, BestFrom, BestMeet, EndNode, backwardParent, backwardDistance, BestWeight);
+}
+
+/**
+ * @brief A fixed set of threads that all run the same job, used by the parallel searches.
+ * The threads are started once and sleep between jobs, so a search can hand out work many times (once per BFS level) cheaply.
+ */
+struct ThreadPool {
+    /**
+     * @param Threads Number of threads including the calling one, 0 means one per core.
+     */
+    explicit ThreadPool(int Threads = 0) {
+        if (Threads <= 0)
+            Threads = max(1, (int)thread::hardware_concurrency());
+        for (int i = 1; i < Threads; i++)
+            workers.push_back(thread(&ThreadPool::work, this, i));
+    }
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> Lock(guard);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& Worker : workers)
+            Worker.join();
+    }
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+    /**
+     * @brief Runs Job(ThreadIndex) on every thread, the calling thread is thread 0, and returns when all of them are done.
+     */
+    void run(const function<void(int)>& Job) {
+        if (workers.empty()) {
+            Job(0);
+            return;
+        }
+        {
+            lock_guard<mutex> Lock(guard);
+            job = &Job;
+            remaining = (int)workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        Job(0);
+        unique_lock<mutex> Lock(guard);
+        done.wait(Lock, [this] { return remaining == 0; });
+    }
+
+private:
+    vector<thread>workers;
+    mutex guard;
+    condition_variable wake, done;
+    const function<void(int)>* job = nullptr;
+    int generation = 0;
+    int remaining = 0;
+    bool stopping = false;
+
+    void work(int Index) {
+        int Seen = 0;
+        while (true) {
+            const function<void(int)>* Job;
+            {
+                unique_lock<mutex> Lock(guard);
+                wake.wait(Lock, [&] { return stopping || generation != Seen; });
+                if (stopping)
+                    return;
+                Seen = generation;
+                Job = job;
+            }
+            (*Job)(Index);
+            lock_guard<mutex> Lock(guard);
+            if (--remaining == 0)
+                done.notify_one();
+        }
+    }
+};
+
+/**
+ * @brief Number of neighbors of Node.
+ */
+template <typename GraphType>
+int NeighborCount(const GraphType& graph, int Node) {
+    int Count = 0;
+    for (auto Neighbor = graph.adjacent(Node).begin(), Last = graph.adjacent(Node).end(); Neighbor != Last; ++Neighbor)
+        Count++;
+    return Count;
+}
+
+/**
+ * @brief Part [First, Last) of Count items that thread Index of Threads works on.
+ */
+inline void ThreadSlice(size_t Count, int Index, int Threads, size_t& First, size_t& Last) {
+    First = Count * Index / Threads;
+    Last = Count * (Index + 1) / Threads;
+}
+
+/**
+ * @brief Level by level BFS over the whole graph on a ThreadPool, for distance fields and reachability.
+ * The visited set and the frontier are bitmaps. Small frontiers are expanded top-down (the frontier looks at its neighbors),
+ * big ones bottom-up (every unvisited node looks for a neighbor in the frontier), switching like Beamer's direction optimizing BFS.
+ * Every new level is then ordered the way the queue of BreadthFirstSearch would hold it (by the queue position of the parent, then
+ * by the position in the parent's neighbors), so distance and parent are exactly the ones BreadthFirstSearch(graph, Source, -1) gives.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used, every edge must go both ways.
+ * @param Source A source node to start BFS from.
+ * @param pool Threads to run on.
+ */
+template <typename GraphType>
+void ParallelBFS(GraphType& graph, int Source, ThreadPool& pool, int Parent = -1) {
+    struct LevelEntry {
+        int parentRank; // Queue position of the parent
+        int position; // Position in the neighbors of the parent
+        int node, parent, weight, degree;
+        bool operator<(const LevelEntry& Other) const {
+            return parentRank < Other.parentRank || (parentRank == Other.parentRank && position < Other.position);
+        }
+    };
+    const int NodeCount = (int)graph.state.size();
+    const size_t Words = (NodeCount + 63) / 64;
+    const int Threads = pool.size();
+    vector<atomic<unsigned long long>>visited(Words), inFrontier(Words);
+    vector<int>rank(NodeCount, -1); // Position in the queue of BreadthFirstSearch
+    vector<vector<int>>found(Threads);
+    vector<long long>degrees(Threads);
+    vector<int>frontier(1, Source);
+    vector<LevelEntry>level;
+
+    // Obstacles and other start nodes are never entered, they start out as visited
+    pool.run([&](int Index) {
+        size_t First, Last;
+        ThreadSlice(Words, Index, Threads, First, Last);
+        long long Degrees = 0;
+        for (size_t Word = First; Word < Last; Word++) {
+            unsigned long long Bits = 0;
+            for (int Node = (int)Word * 64; Node < min(NodeCount, (int)Word * 64 + 64); Node++) {
+                if (graph.state[Node] == Obstacle || graph.state[Node] == Start)
+                    Bits |= 1ULL << (Node & 63);
+                else
+                    Degrees += NeighborCount(graph, Node);
+            }
+            visited[Word].store(Bits, memory_order_relaxed);
+            inFrontier[Word].store(0, memory_order_relaxed);
+        }
+        degrees[Index] = Degrees;
+    });
+    long long UnexploredEdges = 0;
+    for (long long Degrees : degrees)
+        UnexploredEdges += Degrees;
+
+    visited[Source >> 6].fetch_or(1ULL << (Source & 63));
+    rank[Source] = 0;
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+    if (graph.state[Source] != Start)
+        graph.state[Source] = Visited;
+    long long FrontierEdges = NeighborCount(graph, Source);
+    int LevelStart = 0, Ranked = 1;
+    bool BottomUp = false;
+
+    while (!frontier.empty()) {
+        UnexploredEdges -= FrontierEdges;
+        if (!BottomUp && FrontierEdges > UnexploredEdges / 14)
+            BottomUp = true;
+        else if (BottomUp && (long long)frontier.size() * 24 < NodeCount)
+            BottomUp = false;
+
+        if (BottomUp) {
+            pool.run([&](int Index) {
+                size_t First, Last;
+                ThreadSlice(frontier.size(), Index, Threads, First, Last);
+                for (size_t i = First; i < Last; i++)
+                    inFrontier[frontier[i] >> 6].fetch_or(1ULL << (frontier[i] & 63), memory_order_relaxed);
+            });
+            pool.run([&](int Index) {
+                size_t First, Last;
+                ThreadSlice(Words, Index, Threads, First, Last);
+                found[Index].clear();
+                for (size_t Word = First; Word < Last; Word++) {
+                    unsigned long long Unvisited = ~visited[Word].load(memory_order_relaxed);
+                    for (int Bit = 0; Unvisited; Bit++, Unvisited >>= 1) {
+                        int Node = (int)Word * 64 + Bit;
+                        if (!(Unvisited & 1) || Node >= NodeCount)
+                            continue;
+                        for (pair<int, int> NodeAndWeight : graph.adjacent(Node))
+                            if (inFrontier[NodeAndWeight.first >> 6].load(memory_order_relaxed) & (1ULL << (NodeAndWeight.first & 63))) {
+                                found[Index].push_back(Node);
+                                break;
+                            }
+                    }
+                }
+            });
+            pool.run([&](int Index) {
+                size_t First, Last;
+                ThreadSlice(frontier.size(), Index, Threads, First, Last);
+                for (size_t i = First; i < Last; i++)
+                    inFrontier[frontier[i] >> 6].store(0, memory_order_relaxed);
+                for (int Node : found[Index])
+                    visited[Node >> 6].fetch_or(1ULL << (Node & 63), memory_order_relaxed);
+            });
+        }
+        else {
+            pool.run([&](int Index) {
+                size_t First, Last;
+                ThreadSlice(frontier.size(), Index, Threads, First, Last);
+                found[Index].clear();
+                for (size_t i = First; i < Last; i++)
+                    for (pair<int, int> NodeAndWeight : graph.adjacent(frontier[i])) {
+                        int Node = NodeAndWeight.first;
+                        unsigned long long Bit = 1ULL << (Node & 63);
+                        // Only the thread that sets the bit keeps the node
+                        if (!(visited[Node >> 6].load(memory_order_relaxed) & Bit) && !(visited[Node >> 6].fetch_or(Bit, memory_order_relaxed) & Bit))
+                            found[Index].push_back(Node);
+                    }
+            });
+        }
+
+        // Parent of every new node: the node of this level that comes first in the queue
+        size_t NewCount = 0;
+        for (const vector<int>& Nodes : found)
+            NewCount += Nodes.size();
+        level.resize(NewCount);
+        pool.run([&](int Index) {
+            size_t Offset = 0;
+            for (int i = 0; i < Index; i++)
+                Offset += found[i].size();
+            for (int Node : found[Index]) {
+                LevelEntry& Entry = level[Offset++];
+                Entry.node = Node;
+                Entry.parentRank = 0x7FFFFFFF;
+                Entry.degree = 0;
+                for (pair<int, int> NodeAndWeight : graph.adjacent(Node)) {
+                    int Rank = rank[NodeAndWeight.first];
+                    if (Rank >= LevelStart && Rank < Ranked && Rank < Entry.parentRank) {
+                        Entry.parentRank = Rank;
+                        Entry.parent = NodeAndWeight.first;
+                    }
+                    Entry.degree++;
+                }
+                int Position = 0;
+                for (pair<int, int> NodeAndWeight : graph.adjacent(Entry.parent)) {
+                    if (NodeAndWeight.first == Node) {
+                        Entry.position = Position;
+                        Entry.weight = NodeAndWeight.second;
+                        break;
+                    }
+                    Position++;
+                }
+            }
+        });
+        sort(level.begin(), level.end());
+
+        LevelStart = Ranked;
+        FrontierEdges = 0;
+        frontier.resize(NewCount);
+        for (size_t i = 0; i < NewCount; i++) {
+            const LevelEntry& Entry = level[i];
+            frontier[i] = Entry.node;
+            rank[Entry.node] = Ranked++;
+            graph.distance[Entry.node] = graph.distance[Entry.parent] + Entry.weight;
+            graph.parent[Entry.node] = Entry.parent;
+            graph.state[Entry.node] = Visited;
+            FrontierEdges += Entry.degree;
+        }
+    }
+}
+
+/**
+ * @brief Parallel single source shortest paths by delta-stepping, for whole distance maps on weighted graphs.
+ * Nodes are kept in buckets of width Delta. The nodes of the lowest bucket relax their light edges (weight <= Delta) in parallel until
+ * the bucket stays empty, then everything that went through the bucket relaxes its heavy edges once. Distances are lowered with compare and swap.
+ * The parent of every node is picked afterwards as the neighbor DijkstraQ would have used (the one popped first among those giving the
+ * shortest distance), so distance and parent are exactly the ones DijkstraQ(graph, Source, -1) gives.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used, every edge must go both ways.
+ * @param Source A source node to start from.
+ * @param Delta Width of a bucket, around the biggest weight works well (every edge is light then).
+ * @param pool Threads to run on.
+ */
+template <typename GraphType>
+void DeltaStepping(GraphType& graph, int Source, int Delta, ThreadPool& pool, int Parent = -1) {
+    const int NodeCount = (int)graph.state.size();
+    const int Threads = pool.size();
+    const int Unreached = 0x7FFFFFFF;
+    vector<atomic<int>>distance(NodeCount);
+    vector<int>phase(NodeCount, -1), settled(NodeCount, -1); // Last phase/bucket a node was taken in
+    vector<vector<int>>buckets(1, vector<int>(1, Source));
+    vector<vector<int>>improved(Threads);
+    vector<int>current, requests, bucketNodes;
+    pool.run([&](int Index) {
+        size_t First, Last;
+        ThreadSlice(NodeCount, Index, Threads, First, Last);
+        for (size_t Node = First; Node < Last; Node++)
+            distance[Node].store(Unreached, memory_order_relaxed);
+    });
+    distance[Source].store(0);
+
+    // Relaxes the edges of Nodes with Weight <= Delta (Light) or > Delta, and puts the nodes that got shorter in their buckets
+    auto Relax = [&](const vector<int>& Nodes, bool Light) {
+        pool.run([&](int Index) {
+            size_t First, Last;
+            ThreadSlice(Nodes.size(), Index, Threads, First, Last);
+            improved[Index].clear();
+            for (size_t i = First; i < Last; i++) {
+                int Current = Nodes[i];
+                int Distance = distance[Current].load(memory_order_relaxed);
+                for (pair<int, int> NodeAndWeight : graph.adjacent(Current)) {
+                    int Node = NodeAndWeight.first;
+                    int Weight = NodeAndWeight.second;
+                    if ((Weight <= Delta) != Light || graph.state[Node] == Obstacle || graph.state[Node] == Start)
+                        continue;
+                    int NetWeight = Distance + Weight;
+                    int Old = distance[Node].load(memory_order_relaxed);
+                    while (NetWeight < Old)
+                        if (distance[Node].compare_exchange_weak(Old, NetWeight, memory_order_relaxed)) {
+                            improved[Index].push_back(Node);
+                            break;
+                        }
+                }
+            }
+        });
+        for (const vector<int>& Nodes : improved)
+            for (int Node : Nodes) {
+                size_t Bucket = distance[Node].load(memory_order_relaxed) / Delta;
+                if (Bucket >= buckets.size())
+                    buckets.resize(Bucket + 1);
+                buckets[Bucket].push_back(Node);
+            }
+    };
+
+    int Phase = 0;
+    for (size_t Bucket = 0; Bucket < buckets.size(); Bucket++) {
+        bucketNodes.clear();
+        while (!buckets[Bucket].empty()) {
+            current.swap(buckets[Bucket]);
+            buckets[Bucket].clear();
+            // Drop the nodes that moved to a lower distance and the ones that are here twice
+            requests.clear();
+            for (int Node : current)
+                if ((size_t)(distance[Node].load(memory_order_relaxed) / Delta) == Bucket && phase[Node] != Phase) {
+                    phase[Node] = Phase;
+                    requests.push_back(Node);
+                    if (settled[Node] != (int)Bucket) {
+                        settled[Node] = (int)Bucket;
+                        bucketNodes.push_back(Node);
+                    }
+                }
+            Phase++;
+            Relax(requests, true);
+        }
+        Relax(bucketNodes, false);
+    }
+
+    // Distances are final, pick the parents and copy everything to the graph
+    pool.run([&](int Index) {
+        size_t First, Last;
+        ThreadSlice(NodeCount, Index, Threads, First, Last);
+        for (size_t Node = First; Node < Last; Node++) {
+            int Distance = distance[Node].load(memory_order_relaxed);
+            if (Distance == Unreached)
+                continue;
+            graph.distance[Node] = Distance;
+            if (graph.state[Node] != Start)
+                graph.state[Node] = Visited;
+            if ((int)Node == Source)
+                continue;
+            int BestDistance = Unreached, BestParent = -1;
+            for (pair<int, int> NodeAndWeight : graph.adjacent((int)Node)) {
+                int From = distance[NodeAndWeight.first].load(memory_order_relaxed);
+                if (From != Unreached && From + ReverseWeight(graph, (int)Node, NodeAndWeight.first, NodeAndWeight.second) == Distance &&
+                    (From < BestDistance || (From == BestDistance && NodeAndWeight.first < BestParent))) {
+                    BestDistance = From;
+                    BestParent = NodeAndWeight.first;
+                }
+            }
+            graph.parent[Node] = BestParent;
+        }
+    });
+    graph.parent[Source] = Parent;
+}
+
+/**
+ * @brief Manhattan distance on the grid, never more than the real cost since every edge costs at least 1.
+ */
+struct ManhattanHeuristic {
+    int width;
+    int operator()(int Node, int EndNode) const {
+        return abs(Node % width - EndNode % width) + abs(Node / width - EndNode / width);
+    }
+};
+
+/**
+ * @brief Octile distance for grids that can also move diagonally.
+ * Straight and Diagonal must not be more than the cheapest straight and diagonal steps. With integer weights a diagonal of 1 (Chebyshev distance) is always safe.
+ */
+struct OctileHeuristic {
+    int width;
+    int straight = 1;
+    int diagonal = 1;
+    int operator()(int Node, int EndNode) const {
+        int dx = abs(Node % width - EndNode % width);
+        int dy = abs(Node / width - EndNode / width);
+        return straight * (dx + dy) + (diagonal - 2 * straight) * min(dx, dy);
+    }
+};
+
+/**
+ * @brief No estimate at all, A* with this expands the same nodes as Dijkstra.
+ */
+struct ZeroHeuristic {
+    int operator()(int, int) const {
+        return 0;
+    }
+};
+
+/**
+ * @brief A* implementation, Dijkstra that expands the nodes with the smallest distance + estimated distance to EndNode first.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param Source A source node to start A* from.
+ * @param heuristic Functor heuristic(Node, EndNode), must never overestimate the remaining distance (ManhattanHeuristic, OctileHeuristic, ZeroHeuristic).
+ */
+template <typename GraphType, typename Heuristic>
+void AStar(GraphType& graph, int Source, int EndNode, Heuristic heuristic, int Parent = -1) {
+    // (distance + estimate, estimate, index), on ties the node closer to the end comes first
+    typedef tuple<int, int, int> tupleOfInt;
+    priority_queue<tupleOfInt, vector<tupleOfInt>, greater<tupleOfInt>>que; // min heap
+    que.push(make_tuple(heuristic(Source, EndNode), heuristic(Source, EndNode), Source));
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+
+    while (!que.empty()) {
+        int Estimate = get<0>(que.top());
+        int Remaining = get<1>(que.top());
+        Parent = get<2>(que.top());
+        if (Parent == EndNode) {
+            graph.found = 1;
+            break;
+        }
+        que.pop();
+        // A shorter way to this node was pushed after this one
+        if (Estimate - Remaining > graph.distance[Parent])
+            continue;
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
+            int Node = NodeAndWeight.first;
+            int Weight = NodeAndWeight.second;
+            if (graph.state[Node] != Obstacle && graph.state[Node] != Start) {
+                graph.state[Node] = Visited;
+
+                int NetWeight = graph.distance[Parent] + Weight;
+                if (NetWeight < graph.distance[Node]) {
+                    graph.distance[Node] = NetWeight;
+                    graph.parent[Node] = Parent;
+                    int NodeRemaining = heuristic(Node, EndNode);
+                    que.push(make_tuple(NetWeight + NodeRemaining, NodeRemaining, Node));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Anytime Repairing A* (ARA*), A* with the estimate inflated by Inflation finds a path quickly, then the inflation is lowered
+ * step by step towards 1 and every round reuses the search of the last one (only the nodes whose distance went down since they were
+ * expanded are queued again) until the path is the shortest or Deadline / MaxExpansions is reached.
+ * The path is left for GetPath as usual, graph.found is 0 if no path was found in time.
+ *
+ * @param graph Initialized graph (Graph, CsrGraph or GridGraph) that must not have been used.
+ * @param heuristic Functor heuristic(Node, EndNode) that never overestimates (ManhattanHeuristic, OctileHeuristic).
+ * @param Deadline The search stops at this time, and keeps the best path it had.
+ * @param MaxExpansions The search stops after expanding this many nodes, -1 for no limit.
+ * @return The path found costs at most this many times the shortest one (1 when it is the shortest).
+ */
+template <typename GraphType, typename Heuristic>
+double AnytimeAStar(GraphType& graph, int Source, int EndNode, Heuristic heuristic, chrono::steady_clock::time_point Deadline, long long MaxExpansions = -1,
+                    double Inflation = 3.0, double Step = 0.5, int Parent = -1) {
+    enum { Unseen, Open, Closed, Inconsistent };
+    vector<unsigned char> where(graph.state.size(), Unseen);
+    vector<int> inconsistent; // Closed nodes whose distance went down this round, they are queued again in the next one
+    // (distance + inflated estimate, estimate, index), on ties the node closer to the end comes first
+    typedef tuple<double, int, int> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>>que; // min heap
+    double Epsilon = Inflation;
+    auto Key = [&](int Node) {
+        return graph.distance[Node] + Epsilon * heuristic(Node, EndNode);
+    };
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+    where[Source] = Open;
+    que.push(make_tuple(Key(Source), heuristic(Source, EndNode), Source));
+    double Bound = 0;
+    long long Expansions = 0;
+
+    while (true) {
+        // One round, stops once the end can't be improved with this inflation
+        bool OutOfTime = false;
+        while (!que.empty()) {
+            int Node = get<2>(que.top());
+            // Entries of nodes that left the queue or got a smaller key since
+            if (where[Node] != Open || get<0>(que.top()) != Key(Node)) {
+                que.pop();
+                continue;
+            }
+            if (graph.distance[EndNode] <= get<0>(que.top()))
+                break;
+            if (Expansions == MaxExpansions || (Expansions % 64 == 0 && chrono::steady_clock::now() >= Deadline)) {
+                OutOfTime = true;
+                break;
+            }
+            que.pop();
+            where[Node] = Closed;
+            Expansions++;
+            for (pair<int, int> NodeAndWeight : graph.adjacent(Node)) {
+                int Next = NodeAndWeight.first;
+                if (graph.state[Next] == Obstacle || graph.state[Next] == Start)
+                    continue;
+                graph.state[Next] = Visited;
+                int NetWeight = graph.distance[Node] + NodeAndWeight.second;
+                if (NetWeight < graph.distance[Next]) {
+                    graph.distance[Next] = NetWeight;
+                    graph.parent[Next] = Node;
+                    if (where[Next] == Closed) {
+                        where[Next] = Inconsistent;
+                        inconsistent.push_back(Next);
+                    }
+                    else if (where[Next] != Inconsistent) {
+                        where[Next] = Open;
+                        que.push(make_tuple(Key(Next), heuristic(Next, EndNode), Next));
+                    }
+                }
+            }
+        }
+        if (OutOfTime || graph.distance[EndNode] == 0x7FFFFFFF) {
+            // The path of the last round is still there, the distances along it only went down since
+            graph.found = Bound > 0;
+            return Bound;
+        }
+        // Nothing left to expand can lead to a path shorter than LowerBound
+        double LowerBound = graph.distance[EndNode];
+        for (int Node : inconsistent)
+            LowerBound = min(LowerBound, (double)graph.distance[Node] + heuristic(Node, EndNode));
+        for (; !que.empty(); que.pop()) {
+            int Node = get<2>(que.top());
+            if (where[Node] == Open)
+                LowerBound = min(LowerBound, (double)graph.distance[Node] + heuristic(Node, EndNode));
+        }
+        // LowerBound is 0 only when Source is EndNode, that empty path is the shortest
+        Bound = LowerBound > 0 ? min(Epsilon, graph.distance[EndNode] / LowerBound) : 1.0;
+        if (Epsilon <= 1 || Bound <= 1) {
+            graph.found = 1;
+            return max(Bound, 1.0);
+        }
+        // Next round, the open and inconsistent nodes are queued with the new keys and everything else can be expanded again
+        Epsilon = max(1.0, Epsilon - Step);
+        vector<int> queued;
+        for (int Node = 0; Node < (int)where.size(); Node++) {
+            if (where[Node] == Open || where[Node] == Inconsistent)
+                queued.push_back(Node);
+            where[Node] = Unseen;
+        }
+        inconsistent.clear();
+        for (int Node : queued) {
+            where[Node] = Open;
+            que.push(make_tuple(Key(Node), heuristic(Node, EndNode), Node));
+        }
+    }
+}
+
+/**
+ * @brief True if (x, y) is inside the grid and not an obstacle.
+ */
+bool JumpPointWalkable(const GridMap& graph, int x, int y) {
+    return x >= 0 && y >= 0 && x < graph.width && y < graph.height && graph.state[y * graph.width + x] != Obstacle;
+}
+
+/**
+ * @brief True if (x, y) is walkable and costs 1. Forced neighbors are looked for with this, so a junction counts as a wall for the jumps.
+ */
+bool JumpPointOpen(const GridMap& graph, int x, int y) {
+    return JumpPointWalkable(graph, x, y) && graph.cost[y * graph.width + x] == 1;
+}
+
+/**
+ * @brief True if the cell and its 4 neighbors all cost 1, only there the jumps of JPS are allowed to skip the cell.
+ */
+bool JumpPointUniform(const GridMap& graph, int Node) {
+    if (graph.cost[Node] != 1)
+        return false;
+    int x = Node % graph.width;
+    int y = Node / graph.width;
+    return (y == 0 || graph.cost[Node - graph.width] == 1) && (y == graph.height - 1 || graph.cost[Node + graph.width] == 1) &&
+           (x == 0 || graph.cost[Node - 1] == 1) && (x == graph.width - 1 || graph.cost[Node + 1] == 1);
+}
+
+/**
+ * @brief Goes from (x, y) in the direction (dx, dy) until it finds a jump point.
+ * A jump point is the end node, a cell with a forced neighbor (junctions count as walls here), a cell next to a junction, or (when going vertically) a cell from which a horizontal jump finds one.
+ *
+ * @param Cost Gets the cost of the way from (x, y) to the jump point added to it.
+ * @return int The jump point, -1 if the jump ran into an obstacle or the edge of the grid.
+ */
+int JumpPointJump(const GridMap& graph, int x, int y, int dx, int dy, int EndNode, int& Cost) {
+    while (true) {
+        x += dx;
+        y += dy;
+        if (!JumpPointWalkable(graph, x, y))
+            return -1;
+        int Node = y * graph.width + x;
+        Cost += graph.cost[Node];
+        if (Node == EndNode || !JumpPointUniform(graph, Node))
+            return Node;
+        if (dx != 0) {
+            if ((JumpPointOpen(graph, x, y - 1) && !JumpPointOpen(graph, x - dx, y - 1)) ||
+                (JumpPointOpen(graph, x, y + 1) && !JumpPointOpen(graph, x - dx, y + 1)))
+                return Node;
+        }
+        else {
+            if ((JumpPointOpen(graph, x - 1, y) && !JumpPointOpen(graph, x - 1, y - dy)) ||
+                (JumpPointOpen(graph, x + 1, y) && !JumpPointOpen(graph, x + 1, y - dy)))
+                return Node;
+            // Going vertically, the rows on both sides must be checked too
+            int Ignored = 0;
+            if (JumpPointJump(graph, x, y, 1, 0, EndNode, Ignored) != -1 || JumpPointJump(graph, x, y, -1, 0, EndNode, Ignored) != -1)
+                return Node;
+        }
+    }
+}
+
+/**
+ * @brief Jump Point Search (4 directions) on the grid, A* that only puts jump points in the queue.
+ * On cells with weight 1 it jumps in straight lines instead of pushing every cell, around junctions it stops and expands every neighbor like A*.
+ * Only the jump points are marked as Visited, the cells in between get their parent and distance once the end is found so GetPath works as usual.
+ *
+ * @param graph Initialized grid that must not have been used.
+ * @param Source A source node to start JPS from.
+ */
+void JumpPointSearch(GridGraph& graph, int Source, int EndNode, int Parent = -1) {
+    const int Directions[4][2] = { { 0, -1 }, { 0, 1 }, { -1, 0 }, { 1, 0 } }; // up, down, left, right
+    ManhattanHeuristic heuristic = { graph.width };
+    // (distance + estimate, estimate, index)
+    typedef tuple<int, int, int> tupleOfInt;
+    priority_queue<tupleOfInt, vector<tupleOfInt>, greater<tupleOfInt>>que; // min heap
+    que.push(make_tuple(heuristic(Source, EndNode), heuristic(Source, EndNode), Source));
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+
+    while (!que.empty()) {
+        int Estimate = get<0>(que.top());
+        int Remaining = get<1>(que.top());
+        int Node = get<2>(que.top());
+        if (Node == EndNode) {
+            graph.found = 1;
+            break;
+        }
+        que.pop();
+        if (Estimate - Remaining > graph.distance[Node])
+            continue;
+
+        int x = Node % graph.width;
+        int y = Node / graph.width;
+        int Previous = graph.parent[Node];
+        for (int i = 0; i < 4; i++) {
+            int dx = Directions[i][0];
+            int dy = Directions[i][1];
+            // Pruning, only the way back is skipped (a horizontal jump can turn, a vertical one looks sideways as it goes)
+            if (Previous != Parent && JumpPointUniform(graph, Node)) {
+                int px = Previous % graph.width;
+                int py = Previous / graph.width;
+                int ForwardX = (x > px) - (x < px);
+                int ForwardY = (y > py) - (y < py);
+                if (dx == -ForwardX && dy == -ForwardY)
+                    continue;
+            }
+            int Cost = 0;
+            int JumpPoint = JumpPointJump(graph, x, y, dx, dy, EndNode, Cost);
+            if (JumpPoint == -1 || graph.state[JumpPoint] == Start)
+                continue;
+            int NetWeight = graph.distance[Node] + Cost;
+            if (NetWeight < graph.distance[JumpPoint]) {
+                graph.state[JumpPoint] = Visited;
+                graph.distance[JumpPoint] = NetWeight;
+                graph.parent[JumpPoint] = Node;
+                int JumpRemaining = heuristic(JumpPoint, EndNode);
+                que.push(make_tuple(NetWeight + JumpRemaining, JumpRemaining, JumpPoint));
+            }
+        }
+    }
+
+    if (!graph.found)
+        return;
+    // Fill in the cells between the jump points
+    for (int Node = EndNode; graph.parent[Node] != Parent; ) {
+        int JumpFrom = graph.parent[Node];
+        int Step = Node - JumpFrom;
+        Step = abs(Step) >= graph.width ? (Step > 0 ? graph.width : -graph.width) : (Step > 0 ? 1 : -1);
+        for (int Cell = Node; Cell != JumpFrom; Cell -= Step) {
+            graph.parent[Cell] = Cell - Step;
+            if (Cell - Step != JumpFrom)
+                graph.distance[Cell - Step] = graph.distance[Cell] - graph.cost[Cell];
+        }
+        Node = JumpFrom;
+    }
+}
+
+/**
+ * @brief True if the straight line between the centers of From and To only crosses cells that are neither obstacles nor junctions.
+ * Where the line goes exactly through the corner of two cells, both have to be clear (one is enough if CutCorners), like a diagonal step.
+ */
+bool LineOfSight(const GridMap& map, int From, int To, bool CutCorners = false) {
+    int x = From % map.width, y = From / map.width;
+    int dx = abs(To % map.width - x), dy = abs(To / map.width - y);
+    int sx = To % map.width > x ? 1 : -1, sy = To / map.width > y ? 1 : -1;
+    int Error = dx - dy;
+    auto Clear = [&](int cx, int cy) { return map.state[cy * map.width + cx] != Obstacle && map.cost[cy * map.width + cx] == 1; };
+    for (int Steps = dx + dy; ; ) {
+        if (!Clear(x, y))
+            return false;
+        if (Steps == 0)
+            return true;
+        if (Error > 0) {
+            x += sx;
+            Error -= 2 * dy;
+            Steps--;
+        }
+        else if (Error < 0) {
+            y += sy;
+            Error += 2 * dx;
+            Steps--;
+        }
+        else {
+            int Open = Clear(x + sx, y) + Clear(x, y + sy);
+            if (Open == 0 || (Open == 1 && !CutCorners))
+                return false;
+            x += sx;
+            y += sy;
+            Error += 2 * (dx - dy);
+            Steps -= 2;
+        }
+    }
+}
+
+/**
+ * @brief Cells the line from From to To goes through, the same walk as LineOfSight, without From.
+ */
+vector<int> LineCells(const GridMap& map, int From, int To) {
+    vector<int> cells;
+    int x = From % map.width, y = From / map.width;
+    int dx = abs(To % map.width - x), dy = abs(To / map.width - y);
+    int sx = To % map.width > x ? 1 : -1, sy = To / map.width > y ? 1 : -1;
+    int Error = dx - dy;
+    for (int Steps = dx + dy; Steps > 0; ) {
+        if (Error > 0) {
+            x += sx;
+            Error -= 2 * dy;
+            Steps--;
+        }
+        else if (Error < 0) {
+            y += sy;
+            Error += 2 * dx;
+            Steps--;
+        }
+        else {
+            x += sx;
+            y += sy;
+            Error += 2 * (dx - dy);
+            Steps -= 2;
+        }
+        cells.push_back(y * map.width + x);
+    }
+    return cells;
+}
+
+/**
+ * @brief Length of the straight line between the centers of two cells, in tenths of a cell like DiagonalGridGraph's steps.
+ */
+int LineLength(int Width, int From, int To) {
+    int dx = From % Width - To % Width, dy = From / Width - To / Width;
+    return (int)lround(DiagonalGridGraph::Straight * sqrt((double)(dx * dx + dy * dy)));
+}
+
+/**
+ * @brief Theta*, A* on the 8-connected grid where a node can take the parent of its parent when it sees it, so the path is made of
+ * straight lines at any angle instead of grid steps. Lines only go over clear cells (see LineOfSight), junctions are still crossed
+ * step by step at their cost. graph.parent holds the corners of the path, AnyAnglePath gives all the cells.
+ * Lazy Theta* assumes every line is clear and only checks it when the node is expanded, far fewer line of sight checks for about the same path.
+ *
+ * @param graph 8-connected view of an unused GridGraph.
+ * @param Lazy Lazy Theta* instead of Theta*.
+ */
+void ThetaStar(DiagonalGridGraph& graph, int Source, int EndNode, bool Lazy = false, int Parent = -1) {
+    const GridMap& map = graph.grid;
+    // Straight line distance scaled so a diagonal comes out at Diagonal like the grid step (14, a bit under 10 * sqrt(2)), it never
+    // overestimates a mix of grid steps and lines. The plain distance does over many diagonal steps, octile does for lines (24 for 22)
+    const double Scale = DiagonalGridGraph::Diagonal / sqrt(2.0);
+    auto Heuristic = [&](int Node) {
+        int dx = Node % graph.width - EndNode % graph.width, dy = Node / graph.width - EndNode / graph.width;
+        return (int)(Scale * sqrt((double)(dx * dx + dy * dy)));
+    };
+    typedef pair<int, int> pairOfInt;
+    priority_queue<pairOfInt, vector<pairOfInt>, greater<pairOfInt>> que;
+    vector<char> closed(graph.state.size(), 0);
+    graph.distance[Source] = 0;
+    graph.parent[Source] = Parent;
+    que.push(make_pair(Heuristic(Source), Source));
+
+    while (!que.empty()) {
+        int Estimate = que.top().first;
+        int Node = que.top().second;
+        que.pop();
+        if (closed[Node] || Estimate - Heuristic(Node) > graph.distance[Node])
+            continue;
+        if (Lazy && Node != Source && !LineOfSight(map, graph.parent[Node], Node, graph.cut_corners)) {
+            // The line to the assumed parent is blocked, the best expanded neighbor takes over
+            graph.distance[Node] = 0x7FFFFFFF;
+            for (pair<int, int> NeighborAndWeight : graph.adjacent(Node)) {
+                int Neighbor = NeighborAndWeight.first;
+                int Weight = ReverseWeight(graph, Node, Neighbor, NeighborAndWeight.second);
+                if (closed[Neighbor] && graph.distance[Neighbor] + Weight < graph.distance[Node]) {
+                    graph.distance[Node] = graph.distance[Neighbor] + Weight;
+                    graph.parent[Node] = Neighbor;
+                }
+            }
+            // It costs more than it was queued with, back in the queue so cheaper nodes go first
+            if (graph.distance[Node] + Heuristic(Node) > Estimate) {
+                que.push(make_pair(graph.distance[Node] + Heuristic(Node), Node));
+                continue;
+            }
+        }
+        closed[Node] = 1;
+        if (Node == EndNode) {
+            graph.found = 1;
+            break;
+        }
+        int Grandparent = Node == Source ? -1 : graph.parent[Node];
+        for (pair<int, int> NeighborAndWeight : graph.adjacent(Node)) {
+            int Next = NeighborAndWeight.first;
+            if (graph.state[Next] == Obstacle || graph.state[Next] == Start || closed[Next])
+                continue;
+            graph.state[Next] = Visited;
+            // Straight from the grandparent if it can be seen (Lazy Theta* takes it for granted) and is shorter, otherwise a step from Node.
+            // The line isn't always shorter, the steps to Node may be diagonals that cost 14 instead of 14.14
+            int NetWeight = graph.distance[Node] + NeighborAndWeight.second, From = Node;
+            if (Grandparent != -1 && map.cost[Next] == 1 && graph.distance[Grandparent] + LineLength(graph.width, Grandparent, Next) < NetWeight
+                && (Lazy || LineOfSight(map, Grandparent, Next, graph.cut_corners))) {
+                NetWeight = graph.distance[Grandparent] + LineLength(graph.width, Grandparent, Next);
+                From = Grandparent;
+            }
+            if (NetWeight < graph.distance[Next]) {
+                graph.distance[Next] = NetWeight;
+                graph.parent[Next] = From;
+                que.push(make_pair(NetWeight + Heuristic(Next), Next));
+            }
+        }
+    }
+}
+
+/**
+ * @brief The path ThetaStar found with the lines between its corners filled in, like GetPath gives it (without SourceNode, with DestinationNode).
+ */
+vector<int> AnyAnglePath(const DiagonalGridGraph& graph, int DestinationNode, int SourceNode) {
+    vector<int> corners, path;
+    for (int Node = DestinationNode; Node != SourceNode; Node = graph.parent[Node])
+        corners.push_back(Node);
+    corners.push_back(SourceNode);
+    for (size_t i = corners.size() - 1; i > 0; i--) {
+        vector<int> line = LineCells(graph.grid, corners[i], corners[i - 1]);
+        path.insert(path.end(), line.begin(), line.end());
+    }
+    return path;
+}
+
+/**
+ * @brief Get you the path whether you ran BFS, DFS or Dijkstra on the graph.
+ *
+ * @param graph Initialized Graph that have been used.
+ * @param DestinationNode The end node of the path you want to get from the start node. The start node must have been used in the initial BFS, DFS, Dijkstra arguments.
+ * @return vector<int> Path from source node to destination node, If there isn't a path, check if `path.size() == 0 || path[path.size()-1] != SourceNode` afterwards.
+ */
+template <typename GraphType>
+vector<int> GetPath(GraphType& graph, const int DestinationNode, const int SourceNode = -1) {
+    vector<int> path;
+    for (int Node = DestinationNode; Node != SourceNode; Node = graph.parent[Node], graph.state[Node] = Path)
+        path.push_back(Node);
+    graph.state[SourceNode] = Start;
+    graph.state[DestinationNode] = End;
+    reverse(path.begin(), path.end());
+    return path;
+}
+/**
+ * @brief Per query search state (distance, parent, visited, found) that can be reused without clearing it.
+ * It is everything a search writes, the map is only read, so every thread answering queries on the same map needs just its own SearchContext.
+ * Every entry has a stamp, an entry only counts if its stamp is the current epoch, so starting a new query (begin) just bumps the epoch
+ * instead of refilling distance/parent. The queue and heap storage is kept too, after the first queries nothing gets allocated anymore.
+ */
+struct SearchContext {
+    vector<int>distance;
+    vector<int>parent;
+    vector<unsigned>stamp; // Node was reached in the current query if stamp[Node] == epoch
+    unsigned epoch = 0;
+    int found = 0;
+    vector<int>queue; // Storage for the BFS queue
+    vector<pair<int, int>>heap; // Storage for the Dijkstra/A* heap
+
+    /**
+     * @brief Starts a new query on a graph with NodeCount nodes, O(1) unless the size changed or the epoch wrapped around.
+     */
+    void begin(size_t NodeCount) {
+        if (stamp.size() != NodeCount) {
+            distance.assign(NodeCount, 0x7FFFFFFF);
+            parent.assign(NodeCount, -1);
+            stamp.assign(NodeCount, 0);
+            epoch = 0;
+        }
+        if (++epoch == 0) {
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+        found = 0;
+        queue.clear();
+        heap.clear();
+    }
+    bool reached(int Node) const { return stamp[Node] == epoch; }
+    int get_distance(int Node) const { return stamp[Node] == epoch ? distance[Node] : 0x7FFFFFFF; }
+    void reach(int Node, int Distance, int Parent) {
+        stamp[Node] = epoch;
+        distance[Node] = Distance;
+        parent[Node] = Parent;
+    }
+};
+
+/**
+ * @brief BreadthFirstSearch that writes to a SearchContext, the graph is only read so it can be shared.
+ *
+ * @param graph Graph (Graph, CsrGraph, GridGraph or GridMap), only obstacles in graph.state matter.
+ * @param context Search state, previous queries don't need to be cleared.
+ * @return int 1 if EndNode was found.
+ */
+template <typename GraphType>
+int SearchBFS(const GraphType& graph, SearchContext& context, int Source, int EndNode) {
+    context.begin(graph.state.size());
+    context.reach(Source, 0, -1);
+    context.queue.push_back(Source);
+    for (size_t Front = 0; Front < context.queue.size(); Front++) {
+        int Parent = context.queue[Front];
+        if (Parent == EndNode) {
+            context.found = 1;
+            break;
+        }
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
+            int Node = NodeAndWeight.first;
+            if (graph.state[Node] != Obstacle && !context.reached(Node)) {
+                context.reach(Node, context.distance[Parent] + NodeAndWeight.second, Parent);
+                context.queue.push_back(Node);
+            }
+        }
+    }
+    return context.found;
+}
+
+/**
+ * @brief A* that writes to a SearchContext, the graph is only read so it can be shared. With ZeroHeuristic it is Dijkstra (see SearchDijkstra).
+ *
+ * @param graph Graph (Graph, CsrGraph, GridGraph or GridMap), only obstacles in graph.state matter.
+ * @param context Search state, previous queries don't need to be cleared.
+ * @param heuristic Functor heuristic(Node, EndNode) that never overestimates (ManhattanHeuristic, OctileHeuristic, ZeroHeuristic).
+ * @return int 1 if EndNode was found.
+ */
+template <typename GraphType, typename Heuristic>
+int SearchAStar(const GraphType& graph, SearchContext& context, int Source, int EndNode, Heuristic heuristic) {
+    // (distance + estimate, index), negated so the max heap functions give the smallest
+    vector<pair<int, int>>& heap = context.heap;
+    context.begin(graph.state.size());
+    context.reach(Source, 0, -1);
+    heap.push_back(make_pair(-heuristic(Source, EndNode), -Source));
+    while (!heap.empty()) {
+        int Estimate = -heap.front().first;
+        int Parent = -heap.front().second;
+        if (Parent == EndNode) {
+            context.found = 1;
+            break;
+        }
+        pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+        int Distance = context.distance[Parent];
+        // A shorter way to this node was pushed after this one
+        if (Estimate - heuristic(Parent, EndNode) > Distance)
+            continue;
+        for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
+            int Node = NodeAndWeight.first;
+            int NetWeight = Distance + NodeAndWeight.second;
+            if (graph.state[Node] != Obstacle && NetWeight < context.get_distance(Node)) {
+                context.reach(Node, NetWeight, Parent);
+                heap.push_back(make_pair(-(NetWeight + heuristic(Node, EndNode)), -Node));
+                push_heap(heap.begin(), heap.end());
+            }
+        }
+    }
+    return context.found;
+}
+
+/**
+ * @brief DijkstraQ that writes to a SearchContext, the graph is only read so it can be shared.
+ *
+ * @return int 1 if EndNode was found.
+ */
+template <typename GraphType>
+int SearchDijkstra(const GraphType& graph, SearchContext& context, int Source, int EndNode) {
+    return SearchAStar(graph, context, Source, EndNode, ZeroHeuristic());
+}
+
+/**
+ * @brief GetPath for a SearchContext, nothing is marked on the graph.
+ *
+ * @return vector<int> Path from SourceNode to DestinationNode without SourceNode, like GetPath. Empty if DestinationNode wasn't reached.
+ */
+vector<int> GetSearchPath(const SearchContext& context, const int DestinationNode, const int SourceNode) {
+    vector<int> path;
+    if (!context.reached(DestinationNode))
+        return path;
+    for (int Node = DestinationNode; Node != SourceNode; Node = context.parent[Node])
+        path.push_back(Node);
+    reverse(path.begin(), path.end());
+    return path;
+}
+/**
+ * @brief Answers many point to point queries on one map with all the threads of the pool, every thread with its own SearchContext.
+ *
+ * @param map Map shared by all the threads, it must not change while this runs.
+ * @param Queries (source, end) pairs.
+ * @return vector<vector<int>> The path of every query like GetSearchPath gives it, empty when there is no path.
+ */
+vector<vector<int>> AnswerQueries(const GridMap& map, const vector<pair<int, int>>& Queries, ThreadPool& pool) {
+    vector<vector<int>> paths(Queries.size());
+    atomic<size_t> next(0);
+    pool.run([&](int) {
+        SearchContext context;
+        ManhattanHeuristic heuristic = { map.width };
+        // Queries are taken one by one so a long one doesn't hold up a whole slice
+        for (size_t i = next++; i < Queries.size(); i = next++)
+            if (SearchAStar(map, context, Queries[i].first, Queries[i].second, heuristic))
+                paths[i] = GetSearchPath(context, Queries[i].second, Queries[i].first);
+    });
+    return paths;
+}
+/**
+ * @brief Distances from every source to every target, one Dijkstra per source that stops as soon as all the targets are settled.
+ * The sources are shared out to the threads of the pool, each thread with its own SearchContext, so the graph is only read.
+ *
+ * @param graph Graph, CsrGraph, GridGraph or GridMap, only obstacles in graph.state matter.
+ * @return vector<int> Sources.size() x Targets.size() matrix, row by row, 0x7FFFFFFF where a target can't be reached.
+ */
+template <typename GraphType>
+vector<int> DistanceTable(const GraphType& graph, const vector<int>& Sources, const vector<int>& Targets, ThreadPool& pool) {
+    const size_t TargetCount = Targets.size();
+    vector<int> table(Sources.size() * TargetCount, 0x7FFFFFFF);
+    // How many times every node is a target, the same node may be asked for twice
+    vector<int> targetCount(graph.state.size(), 0);
+    for (int Target : Targets)
+        targetCount[Target]++;
+    atomic<size_t> next(0);
+    pool.run([&](int) {
+        SearchContext context;
+        vector<pair<int, int>>& heap = context.heap;
+        for (size_t Row = next++; Row < Sources.size(); Row = next++) {
+            context.begin(graph.state.size());
+            context.reach(Sources[Row], 0, -1);
+            heap.push_back(make_pair(0, -Sources[Row]));
+            size_t Remaining = TargetCount;
+            while (!heap.empty() && Remaining > 0) {
+                int Distance = -heap.front().first;
+                int Parent = -heap.front().second;
+                pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+                if (Distance > context.distance[Parent])
+                    continue;
+                Remaining -= targetCount[Parent];
+                for (pair<int, int> NodeAndWeight : graph.adjacent(Parent)) {
+                    int Node = NodeAndWeight.first;
+                    int NetWeight = Distance + NodeAndWeight.second;
+                    if (graph.state[Node] != Obstacle && NetWeight < context.get_distance(Node)) {
+                        context.reach(Node, NetWeight, Parent);
+                        heap.push_back(make_pair(-NetWeight, -Node));
+                        push_heap(heap.begin(), heap.end());
+                    }
+                }
+            }
+            // Whatever is still in the heap is farther than every target, the distances of the targets are final
+            for (size_t Column = 0; Column < TargetCount; Column++)
+                table[Row * TargetCount + Column] = context.get_distance(Targets[Column]);
+        }
+    });
+    return table;
+}
+
+/**
+ * @brief Distance to one goal from every cell of a grid and the direction to step in from there, for many agents going to the same place.
+ * One search from the goal answers every agent, after that a move is next(Node). When cells are painted, update_cell only repairs the cells
+ * whose way to the goal went through the changed cell and the ones that get closer through it.
+ */
+struct FlowField {
+    const GridMap* map = nullptr;
+    int goal = -1;
+    vector<int>distance; // Cost of going from the cell to the goal, 0x7FFFFFFF if it can't
+    vector<signed char>direction; // 0 up, 1 down, 2 left, 3 right (the GridMap neighbor order), -1 at the goal and where there is no way
+    vector<int>touched; // Cells whose distance the last build or update_cell changed
+
+    /**
+     * @brief Dijkstra from Goal with the edges turned around, the map has to stay alive as long as the field is used.
+     */
+    void build(const GridMap& Map, int Goal) {
+        map = &Map;
+        goal = Goal;
+        distance.assign(Map.state.size(), 0x7FFFFFFF);
+        direction.assign(Map.state.size(), -1);
+        mark.assign(Map.state.size(), 0);
+        touched.clear();
+        heap.clear();
+        if (Map.state[Goal] != Obstacle)
+            seed(Goal, 0);
+        spread();
+        for (int Node = 0; Node < (int)distance.size(); Node++)
+            direction[Node] = best_direction(Node);
+    }
+    /**
+     * @brief Same field as build, the distances come from DeltaStepping and the directions are filled by all the threads of the pool.
+     * Going into a cell costs the cost of that cell, so the cost of a way back is the cost of the way there - cost[Node] + cost[Goal].
+     */
+    void build_parallel(const GridMap& Map, int Goal, ThreadPool& pool) {
+        map = &Map;
+        goal = Goal;
+        mark.assign(Map.state.size(), 0);
+        touched.clear();
+        GridGraph work;
+        work.resize(Map.width, Map.height);
+        work.cost = Map.cost;
+        // DeltaStepping doesn't go into Start cells and marks what it visits, so it runs on a copy with only the obstacles
+        for (size_t Node = 0; Node < Map.state.size(); Node++)
+            work.state[Node] = Map.state[Node] == Obstacle ? Obstacle : Empty;
+        distance.assign(Map.state.size(), 0x7FFFFFFF);
+        direction.assign(Map.state.size(), -1);
+        if (Map.state[Goal] == Obstacle)
+            return;
+        work.state[Goal] = Start;
+        DeltaStepping(work, Goal, *max_element(Map.cost.begin(), Map.cost.end()), pool);
+        const int Threads = pool.size();
+        pool.run([&](int Index) {
+            size_t First, Last;
+            ThreadSlice(distance.size(), Index, Threads, First, Last);
+            for (size_t Node = First; Node < Last; Node++)
+                if (work.distance[Node] != 0x7FFFFFFF)
+                    distance[Node] = (int)Node == Goal ? 0 : work.distance[Node] - Map.cost[Node] + Map.cost[Goal];
+        });
+        pool.run([&](int Index) {
+            size_t First, Last;
+            ThreadSlice(distance.size(), Index, Threads, First, Last);
+            for (size_t Node = First; Node < Last; Node++)
+                direction[Node] = best_direction((int)Node);
+        });
+    }
+    /**
+     * @brief Neighbor to step into from Node on a shortest way to the goal, -1 at the goal or if the goal can't be reached.
+     */
+    int next(int Node) const {
+        switch (direction[Node]) {
+        case 0: return Node - map->width;
+        case 1: return Node + map->width;
+        case 2: return Node - 1;
+        case 3: return Node + 1;
+        default: return -1;
+        }
+    }
+    /**
+     * @brief Repairs the field after the state or cost of Node changed.
+     * The cells whose way went through Node lose their distance and get it back from the cells around them, then a Dijkstra spreads
+     * whatever got shorter (that also covers Node getting cheaper or open). Only those cells and their neighbors are looked at.
+     */
+    void update_cell(int Node) {
+        for (int Cell : touched)
+            mark[Cell] = 0;
+        touched.clear();
+        heap.clear();
+        // Cells whose steps lead through Node
+        touched.push_back(Node);
+        mark[Node] = 1;
+        for (size_t i = 0; i < touched.size(); i++)
+            for (pair<int, int> NeighborAndCost : map->adjacent(touched[i])) {
+                int Neighbor = NeighborAndCost.first;
+                if (!mark[Neighbor] && next(Neighbor) == touched[i]) {
+                    mark[Neighbor] = 1;
+                    touched.push_back(Neighbor);
+                }
+            }
+        for (int Cell : touched)
+            distance[Cell] = 0x7FFFFFFF;
+        // Back from the cells around them
+        size_t Lost = touched.size();
+        for (size_t i = 0; i < Lost; i++) {
+            int Cell = touched[i];
+            if (map->state[Cell] == Obstacle)
+                continue;
+            if (Cell == goal) {
+                seed(Cell, 0);
+                continue;
+            }
+            int Best = 0x7FFFFFFF;
+            for (pair<int, int> NeighborAndCost : map->adjacent(Cell))
+                if (!mark[NeighborAndCost.first] && distance[NeighborAndCost.first] != 0x7FFFFFFF)
+                    Best = min(Best, distance[NeighborAndCost.first] + NeighborAndCost.second);
+            if (Best != 0x7FFFFFFF)
+                seed(Cell, Best);
+        }
+        spread();
+        // A cell can only turn if one of its neighbors changed
+        for (size_t i = 0; i < touched.size(); i++) {
+            int Cell = touched[i];
+            direction[Cell] = best_direction(Cell);
+            for (pair<int, int> NeighborAndCost : map->adjacent(Cell))
+                direction[NeighborAndCost.first] = best_direction(NeighborAndCost.first);
+        }
+    }
+
+private:
+    vector<char>mark; // Cell is in touched
+    vector<pair<int, int>>heap; // (-distance, -cell)
+
+    void seed(int Node, int Distance) {
+        distance[Node] = Distance;
+        heap.push_back(make_pair(-Distance, -Node));
+        push_heap(heap.begin(), heap.end());
+        if (!mark[Node]) {
+            mark[Node] = 1;
+            touched.push_back(Node);
+        }
+    }
+    /**
+     * @brief Dijkstra on the turned around edges from everything in the heap: stepping from a neighbor into Cell costs cost[Cell].
+     */
+    void spread() {
+        while (!heap.empty()) {
+            int Distance = -heap.front().first;
+            int Cell = -heap.front().second;
+            pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+            if (Distance > distance[Cell])
+                continue;
+            int NetWeight = Distance + map->cost[Cell];
+            for (pair<int, int> NeighborAndCost : map->adjacent(Cell)) {
+                int Neighbor = NeighborAndCost.first;
+                if (map->state[Neighbor] != Obstacle && NetWeight < distance[Neighbor])
+                    seed(Neighbor, NetWeight);
+            }
+        }
+    }
+    signed char best_direction(int Node) const {
+        if (Node == goal || distance[Node] == 0x7FFFFFFF || map->state[Node] == Obstacle)
+            return -1;
+        const int Offsets[4] = { -map->width, map->width, -1, 1 };
+        signed char Best = -1;
+        int BestDistance = 0x7FFFFFFF;
+        int x = Node % map->width, y = Node / map->width;
+        for (signed char Direction = 0; Direction < 4; Direction++) {
+            if ((Direction == 0 && y == 0) || (Direction == 1 && y == map->height - 1) || (Direction == 2 && x == 0) || (Direction == 3 && x == map->width - 1))
+                continue;
+            int Neighbor = Node + Offsets[Direction];
+            if (map->state[Neighbor] == Obstacle || distance[Neighbor] == 0x7FFFFFFF)
+                continue;
+            if (distance[Neighbor] + map->cost[Neighbor] < BestDistance) {
+                BestDistance = distance[Neighbor] + map->cost[Neighbor];
+                Best = Direction;
+            }
+        }
+        return Best;
+    }
+};
+
+/**
+ * @brief Grid stored in bit planes: one bit per cell for obstacles, one for visited and four for the cost, instead of a 4 byte NodeState.
+ * That is 6 bits a cell against the 40 of a GridMap (NodeState and cost), about 6.7 times smaller, a row of a 4096 wide map is 512 bytes
+ * per plane and stays in L1. The searches still go cell by cell: the four neighbors of a cell are four bit tests in (blocked | visited),
+ * the planes have a blocked border of one cell all around so they need no bounds checks. Nodes are numbered y * width + x like everywhere else.
+ */
+struct PackedGrid {
+    int width = 0;
+    int height = 0;
+    size_t stride = 0; // Words per row, with the border
+    vector<unsigned long long>blocked; // Obstacles and the border
+    vector<unsigned long long>visited; // Written by the searches, cleared when one starts
+    vector<unsigned char>cost; // Two cells per byte, the low four bits are the even node
+
+    /**
+     * @brief Packs a GridMap, only obstacles and costs are kept.
+     *
+     * @return bool false if a cost doesn't fit in four bits (1 to 15).
+     */
+    bool build(const GridMap& map) {
+        width = map.width;
+        height = map.height;
+        stride = (width + 2 + 63) / 64;
+        blocked.assign(stride * (height + 2), ~0ULL);
+        visited.assign(blocked.size(), 0);
+        cost.assign(((size_t)width * height + 1) / 2, 0);
+        for (int Node = 0; Node < width * height; Node++) {
+            if (map.cost[Node] > 15)
+                return false;
+            cost[Node >> 1] |= map.cost[Node] << ((Node & 1) * 4);
+            if (map.state[Node] != Obstacle)
+                set_bit(blocked, bit(Node), false);
+        }
+        return true;
+    }
+    size_t bit(int Node) const {
+        return (Node / width + 1) * stride * 64 + Node % width + 1;
+    }
+    int node_cost(int Node) const {
+        return cost[Node >> 1] >> ((Node & 1) * 4) & 15;
+    }
+    void set_obstacle(int Node, bool Obstacle) {
+        set_bit(blocked, bit(Node), Obstacle);
+    }
+    /**
+     * @brief Changes the cost of a cell.
+     *
+     * @return bool false if Weight doesn't fit in four bits (1 to 15), the cell keeps its cost then.
+     */
+    bool update_node_weight(int Node, int Weight) {
+        if (Weight < 1 || Weight > 15)
+            return false;
+        cost[Node >> 1] = (unsigned char)((cost[Node >> 1] & (0xF0 >> ((Node & 1) * 4))) | Weight << ((Node & 1) * 4));
+        return true;
+    }
+    bool is_visited(int Node) const {
+        return visited[bit(Node) >> 6] >> (bit(Node) & 63) & 1;
+    }
+    void visit(int Node) {
+        set_bit(visited, bit(Node), true);
+    }
+    void clear_visited() {
+        fill(visited.begin(), visited.end(), 0);
+    }
+    /**
+     * @brief Neighbors of Node that are neither blocked nor visited, bit i for direction i (up, down, left, right like GridMap::adjacent).
+     * One bit test per neighbor, without bounds checks thanks to the border.
+     */
+    unsigned open_neighbors(int Node) const {
+        const size_t Bit = bit(Node), Row = stride * 64;
+        return (unsigned)(closed(Bit - Row) | closed(Bit + Row) << 1 | closed(Bit - 1) << 2 | closed(Bit + 1) << 3) ^ 15;
+    }
+
+private:
+    unsigned long long closed(size_t Bit) const {
+        return (blocked[Bit >> 6] | visited[Bit >> 6]) >> (Bit & 63) & 1;
+    }
+    static void set_bit(vector<unsigned long long>& plane, size_t Bit, bool Value) {
+        if (Value)
+            plane[Bit >> 6] |= 1ULL << (Bit & 63);
+        else
+            plane[Bit >> 6] &= ~(1ULL << (Bit & 63));
+    }
+};
+
+/**
+ * @brief SearchBFS on a PackedGrid, a node is marked visited when it is queued so every neighbor test is one look at the planes.
+ * Same distances and parents as SearchBFS on the GridMap it was packed from.
+ *
+ * @return int 1 if EndNode was found.
+ */
+int PackedBFS(PackedGrid& grid, SearchContext& context, int Source, int EndNode) {
+    const int Offsets[4] = { -grid.width, grid.width, -1, 1 };
+    grid.clear_visited();
+    context.begin((size_t)grid.width * grid.height);
+    context.reach(Source, 0, -1);
+    grid.visit(Source);
+    context.queue.push_back(Source);
+    for (size_t Front = 0; Front < context.queue.size(); Front++) {
+        int Parent = context.queue[Front];
+        if (Parent == EndNode) {
+            context.found = 1;
+            break;
+        }
+        unsigned Open = grid.open_neighbors(Parent);
+        for (int Direction = 0; Open; Direction++, Open >>= 1)
+            if (Open & 1) {
+                int Node = Parent + Offsets[Direction];
+                grid.visit(Node);
+                context.reach(Node, context.distance[Parent] + grid.node_cost(Node), Parent);
+                context.queue.push_back(Node);
+            }
+    }
+    return context.found;
+}
+
+/**
+ * @brief SearchDijkstra on a PackedGrid, the visited plane holds the settled nodes so they drop out with the obstacles in one test.
+ * Same distances and parents as SearchDijkstra on the GridMap it was packed from.
+ *
+ * @return int 1 if EndNode was found.
+ */
+int PackedDijkstra(PackedGrid& grid, SearchContext& context, int Source, int EndNode) {
+    const int Offsets[4] = { -grid.width, grid.width, -1, 1 };
+    vector<pair<int, int>>& heap = context.heap;
+    grid.clear_visited();
+    context.begin((size_t)grid.width * grid.height);
+    context.reach(Source, 0, -1);
+    heap.push_back(make_pair(0, -Source));
+    while (!heap.empty()) {
+        int Distance = -heap.front().first;
+        int Parent = -heap.front().second;
+        if (Parent == EndNode) {
+            context.found = 1;
+            break;
+        }
+        pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+        if (Distance > context.distance[Parent])
+            continue;
+        grid.visit(Parent);
+        unsigned Open = grid.open_neighbors(Parent);
+        for (int Direction = 0; Open; Direction++, Open >>= 1)
+            if (Open & 1) {
+                int Node = Parent + Offsets[Direction];
+                int NetWeight = Distance + grid.node_cost(Node);
+                if (NetWeight < context.get_distance(Node)) {
+                    context.reach(Node, NetWeight, Parent);
+                    heap.push_back(make_pair(-NetWeight, -Node));
+                    push_heap(heap.begin(), heap.end());
+                }
+            }
+    }
+    return context.found;
+}
+
+/**
+ * @brief Obstacle plane for WavefrontBFS, cut into 8x8 tiles of one 64 bit word each (bit 8 * row + column of the tile).
+ * A wave in any direction crosses a tile in about 8 layers, with words along the rows a diagonal wave would keep every word busy for
+ * 64 layers with one cell in it. A ring of blocked tiles goes around the map, so the tiles next to a tile always exist.
+ */
+struct WavefrontGrid {
+    int width = 0;
+    int height = 0;
+    int tilesX = 0; // Tiles per row, with the border
+    int tilesY = 0;
+    vector<unsigned long long>blocked; // Obstacles, the border and the cells past the edge of the map
+
+    void build(const GridMap& map) {
+        width = map.width;
+        height = map.height;
+        tilesX = (width + 7) / 8 + 2;
+        tilesY = (height + 7) / 8 + 2;
+        blocked.assign((size_t)tilesX * tilesY, ~0ULL);
+        for (int Node = 0; Node < width * height; Node++)
+            set_obstacle(Node, map.state[Node] == Obstacle);
+    }
+    size_t tile(int Node) const {
+        return (size_t)(Node / width / 8 + 1) * tilesX + Node % width / 8 + 1;
+    }
+    int bit(int Node) const {
+        return Node / width % 8 * 8 + Node % width % 8;
+    }
+    void set_obstacle(int Node, bool Obstacle) {
+        if (Obstacle)
+            blocked[tile(Node)] |= 1ULL << bit(Node);
+        else
+            blocked[tile(Node)] &= ~(1ULL << bit(Node));
+    }
+};
+
+/**
+ * @brief One BFS layer for the Count tiles starting at First: a cell joins if a neighbor is in the frontier and it is neither blocked
+ * nor visited, (left | right | above | below) & ~blocked & ~visited. The new cells are added to Visited.
+ * Frontier is read from TilesX words before First to TilesX words after the last tile (the AVX2 loads stay inside that),
+ * the caller pads it so the tiles of the border ring can be expanded too.
+ */
+inline void WavefrontExpand(const unsigned long long* Frontier, const unsigned long long* Blocked, unsigned long long* Visited,
+                            unsigned long long* Next, size_t First, size_t Count, size_t TilesX) {
+    const unsigned long long FirstColumn = 0x0101010101010101ULL, LastColumn = 0x8080808080808080ULL;
+    size_t i = First;
+    const size_t Last = First + Count;
+#if defined(__AVX2__)
+    const __m256i First4 = _mm256_set1_epi64x((long long)FirstColumn), Last4 = _mm256_set1_epi64x((long long)LastColumn);
+    for (; i + 4 <= Last; i += 4) {
+        __m256i Here = _mm256_loadu_si256((const __m256i*)(Frontier + i));
+        __m256i Left = _mm256_loadu_si256((const __m256i*)(Frontier + i - 1));
+        __m256i Right = _mm256_loadu_si256((const __m256i*)(Frontier + i + 1));
+        __m256i Above = _mm256_loadu_si256((const __m256i*)(Frontier + i - TilesX));
+        __m256i Below = _mm256_loadu_si256((const __m256i*)(Frontier + i + TilesX));
+        // From the cell on the left (column 7 of the left tile for column 0) and from the right
+        __m256i Reached = _mm256_or_si256(_mm256_andnot_si256(First4, _mm256_slli_epi64(Here, 1)), _mm256_and_si256(First4, _mm256_srli_epi64(Left, 7)));
+        Reached = _mm256_or_si256(Reached, _mm256_andnot_si256(Last4, _mm256_srli_epi64(Here, 1)));
+        Reached = _mm256_or_si256(Reached, _mm256_and_si256(Last4, _mm256_slli_epi64(Right, 7)));
+        // From the row above (row 7 of the tile above for row 0) and from below
+        Reached = _mm256_or_si256(Reached, _mm256_or_si256(_mm256_slli_epi64(Here, 8), _mm256_srli_epi64(Above, 56)));
+        Reached = _mm256_or_si256(Reached, _mm256_or_si256(_mm256_srli_epi64(Here, 8), _mm256_slli_epi64(Below, 56)));
+        __m256i Seen = _mm256_loadu_si256((const __m256i*)(Visited + i));
+        __m256i New = _mm256_andnot_si256(_mm256_or_si256(_mm256_loadu_si256((const __m256i*)(Blocked + i)), Seen), Reached);
+        _mm256_storeu_si256((__m256i*)(Next + i), New);
+        _mm256_storeu_si256((__m256i*)(Visited + i), _mm256_or_si256(Seen, New));
+    }
+#endif
+    for (; i < Last; i++) {
+        unsigned long long Here = Frontier[i];
+        unsigned long long Reached = (Here << 1 & ~FirstColumn) | (Frontier[i - 1] >> 7 & FirstColumn)
+                                   | (Here >> 1 & ~LastColumn) | (Frontier[i + 1] << 7 & LastColumn)
+                                   | Here << 8 | Frontier[i - TilesX] >> 56
+                                   | Here >> 8 | Frontier[i + TilesX] << 56;
+        Next[i] = Reached & ~Blocked[i] & ~Visited[i];
+        Visited[i] |= Next[i];
+    }
+}
+
+/**
+ * @brief Whole map BFS that expands a layer 64 cells at a time with shifts and masks instead of a queue push per cell.
+ * Only the tiles next to the last layer are looked at, a bitmap with one bit per tile keeps track of them, and runs of neighboring
+ * tiles go through WavefrontExpand together. Uses AVX2 (4 tiles at once) when the compiler targets it.
+ *
+ * @param Distance Number of steps from Source to every cell, 0x7FFFFFFF where it can't be reached. Same layers as BreadthFirstSearch
+ * on a grid where every cell costs 1.
+ */
+void WavefrontBFS(const WavefrontGrid& grid, int Source, vector<int>& Distance) {
+    const size_t Tiles = grid.blocked.size(), TilesX = grid.tilesX;
+    Distance.assign((size_t)grid.width * grid.height, 0x7FFFFFFF);
+    // The tiles of the border ring are expanded too (they never get a cell), so WavefrontExpand reads a row of tiles and a few words
+    // past both ends of the map, the planes get that much zero padding on each side
+    const size_t Padding = TilesX + 4;
+    vector<unsigned long long> frontierPlane(Tiles + 2 * Padding, 0), nextPlane(Tiles + 2 * Padding, 0), visitedPlane(Tiles + 2 * Padding, 0);
+    unsigned long long* frontier = frontierPlane.data() + Padding;
+    unsigned long long* next = nextPlane.data() + Padding;
+    unsigned long long* visited = visitedPlane.data() + Padding;
+    vector<unsigned long long> candidates((Tiles + 63) / 64, 0); // One bit per tile
+    vector<size_t> activeTiles, newTiles;
+
+    size_t SourceTile = grid.tile(Source);
+    frontier[SourceTile] = visited[SourceTile] = 1ULL << grid.bit(Source);
+    Distance[Source] = 0;
+    activeTiles.push_back(SourceTile);
+
+    for (int Layer = 1; !activeTiles.empty(); Layer++) {
+        // Tiles that can get a cell this layer: the active ones and the tiles around them (the border ring never can)
+        for (size_t Tile : activeTiles) {
+            const size_t Around[5] = { Tile - TilesX, Tile - 1, Tile, Tile + 1, Tile + TilesX };
+            for (size_t Candidate : Around)
+                candidates[Candidate >> 6] |= 1ULL << (Candidate & 63);
+        }
+        newTiles.clear();
+        for (size_t Bucket = 0; Bucket < candidates.size(); Bucket++)
+            while (candidates[Bucket]) {
+                // Next run of candidate tiles in this bucket
+                int Begin = TrailingZeros(candidates[Bucket]);
+                unsigned long long Rest = ~(candidates[Bucket] >> Begin);
+                int Length = Rest ? TrailingZeros(Rest) : 64 - Begin;
+                candidates[Bucket] &= Length == 64 ? 0 : ~(((1ULL << Length) - 1) << Begin);
+                size_t First = Bucket * 64 + Begin;
+                WavefrontExpand(frontier, grid.blocked.data(), visited, next, First, Length, TilesX);
+                for (size_t Tile = First; Tile < First + Length; Tile++)
+                    if (next[Tile]) {
+                        newTiles.push_back(Tile);
+                        int Row = (int)(Tile / TilesX - 1) * 8, Column = (int)(Tile % TilesX - 1) * 8;
+                        for (unsigned long long Bits = next[Tile]; Bits; Bits &= Bits - 1) {
+                            int Bit = TrailingZeros(Bits);
+                            Distance[(Row + Bit / 8) * grid.width + Column + Bit % 8] = Layer;
+                        }
+                    }
+            }
+        // The new layer becomes the frontier, only the tiles that were used need clearing
+        for (size_t Tile : activeTiles)
+            frontier[Tile] = 0;
+        for (size_t Tile : newTiles) {
+            frontier[Tile] = next[Tile];
+            next[Tile] = 0;
+        }
+        activeTiles.swap(newTiles);
+    }
+}
+
+/**
+ * @brief Which connected part of the grid every free cell is in, so a query can tell there is no path before searching.
+ * Built with union-find, then kept as one label per cell so connected is two reads. update_cell follows the edits: a cell that opens
+ * joins the parts around it (the smaller ones are relabeled), a new obstacle may split its part, so floods start from the cells around
+ * it in turns and stop as soon as all but one of them are finished or they have met, only the cut off pieces get a new label.
+ * The parts are the same with 8 directions (DiagonalGridGraph): a diagonal step always has a free cell beside it.
+ */
+struct ComponentIndex {
+    int width = 0;
+    int height = 0;
+    vector<int>label; // Part of every cell, -1 for obstacles
+    vector<int>size; // Cells in every part
+
+    void build(const GridMap& map) {
+        width = map.width;
+        height = map.height;
+        const int NodeCount = width * height;
+        vector<int> root(NodeCount);
+        for (int Node = 0; Node < NodeCount; Node++)
+            root[Node] = Node;
+        auto Find = [&](int Node) {
+            while (root[Node] != Node)
+                Node = root[Node] = root[root[Node]];
+            return Node;
+        };
+        for (int Node = 0; Node < NodeCount; Node++) {
+            if (map.state[Node] == Obstacle)
+                continue;
+            // Right and down is enough, left and up were joined from the other side
+            if (Node % width < width - 1 && map.state[Node + 1] != Obstacle)
+                root[Find(Node)] = Find(Node + 1);
+            if (Node / width < height - 1 && map.state[Node + width] != Obstacle)
+                root[Find(Node)] = Find(Node + width);
+        }
+        label.assign(NodeCount, -1);
+        size.clear();
+        vector<int> labelOfRoot(NodeCount, -1);
+        for (int Node = 0; Node < NodeCount; Node++)
+            if (map.state[Node] != Obstacle) {
+                int Root = Find(Node);
+                if (labelOfRoot[Root] == -1) {
+                    labelOfRoot[Root] = (int)size.size();
+                    size.push_back(0);
+                }
+                label[Node] = labelOfRoot[Root];
+                size[label[Node]]++;
+            }
+        stamp.assign(NodeCount, 0);
+        epoch = 0;
+    }
+    /**
+     * @brief False if there is no path between the two cells (or one is an obstacle), O(1).
+     */
+    bool connected(int From, int To) const {
+        return label[From] != -1 && label[From] == label[To];
+    }
+    /**
+     * @brief Has to be called when Node became or stopped being an obstacle.
+     */
+    void update_cell(const GridMap& map, int Node) {
+        if ((map.state[Node] == Obstacle) == (label[Node] == -1))
+            return;
+        if (map.state[Node] == Obstacle)
+            cut(Node);
+        else
+            join(Node);
+    }
+
+private:
+    vector<unsigned>stamp; // Cell was reached by a flood of the current cut if stamp == epoch
+    unsigned epoch = 0;
+    vector<unsigned char>owner; // Which flood reached it
+    vector<int>flood[4];
+
+    int neighbors(int Node, int* Neighbors) const {
+        int Count = 0;
+        int x = Node % width, y = Node / width;
+        if (y > 0 && label[Node - width] != -1)
+            Neighbors[Count++] = Node - width;
+        if (y < height - 1 && label[Node + width] != -1)
+            Neighbors[Count++] = Node + width;
+        if (x > 0 && label[Node - 1] != -1)
+            Neighbors[Count++] = Node - 1;
+        if (x < width - 1 && label[Node + 1] != -1)
+            Neighbors[Count++] = Node + 1;
+        return Count;
+    }
+    void join(int Node) {
+        int Around[4];
+        int Count = neighbors(Node, Around);
+        // The biggest part around keeps its label, the others are flooded over with it
+        int Biggest = -1;
+        for (int i = 0; i < Count; i++)
+            if (Biggest == -1 || size[label[Around[i]]] > size[Biggest])
+                Biggest = label[Around[i]];
+        if (Biggest == -1) {
+            Biggest = (int)size.size();
+            size.push_back(0);
+        }
+        label[Node] = Biggest;
+        size[Biggest]++;
+        for (int i = 0; i < Count; i++) {
+            int Old = label[Around[i]];
+            if (Old == Biggest)
+                continue;
+            size[Biggest] += size[Old];
+            size[Old] = 0;
+            vector<int>& cells = flood[0];
+            cells.assign(1, Around[i]);
+            label[Around[i]] = Biggest;
+            for (size_t Front = 0; Front < cells.size(); Front++) {
+                int Next[4];
+                int NextCount = neighbors(cells[Front], Next);
+                for (int j = 0; j < NextCount; j++)
+                    if (label[Next[j]] == Old) {
+                        label[Next[j]] = Biggest;
+                        cells.push_back(Next[j]);
+                    }
+            }
+        }
+    }
+    void cut(int Node) {
+        int Old = label[Node];
+        label[Node] = -1;
+        size[Old]--;
+        int Around[4];
+        int Count = neighbors(Node, Around);
+        if (Count < 2)
+            return;
+        owner.resize(label.size());
+        if (++epoch == 0) {
+            fill(stamp.begin(), stamp.end(), 0);
+            epoch = 1;
+        }
+        // Floods that met are one group, a group is finished when all its floods ran out of cells
+        int group[4];
+        size_t front[4];
+        for (int i = 0; i < Count; i++) {
+            group[i] = i;
+            front[i] = 0;
+            flood[i].assign(1, Around[i]);
+            stamp[Around[i]] = epoch;
+            owner[Around[i]] = (unsigned char)i;
+        }
+        while (true) {
+            int Groups = 0, Finished = -1;
+            for (int i = 0; i < Count; i++) {
+                if (group[i] != i)
+                    continue;
+                Groups++;
+                bool Done = true;
+                for (int j = 0; j < Count; j++)
+                    if (group[j] == i && front[j] < flood[j].size())
+                        Done = false;
+                if (Done)
+                    Finished = i;
+            }
+            if (Groups <= 1)
+                break; // What is left keeps the old label
+            if (Finished != -1) {
+                // Cut off from the rest, gets a label of its own
+                int New = (int)size.size();
+                size.push_back(0);
+                for (int j = 0; j < Count; j++)
+                    if (group[j] == Finished) {
+                        for (int Cell : flood[j])
+                            label[Cell] = New;
+                        size[New] += (int)flood[j].size();
+                        size[Old] -= (int)flood[j].size();
+                        group[j] = -1;
+                    }
+                continue;
+            }
+            // One cell of every flood
+            for (int i = 0; i < Count; i++) {
+                if (group[i] < 0 || front[i] == flood[i].size())
+                    continue;
+                int Next[4];
+                int NextCount = neighbors(flood[i][front[i]++], Next);
+                for (int j = 0; j < NextCount; j++) {
+                    int Cell = Next[j];
+                    if (stamp[Cell] != epoch) {
+                        stamp[Cell] = epoch;
+                        owner[Cell] = (unsigned char)i;
+                        flood[i].push_back(Cell);
+                    }
+                    else if (group[owner[Cell]] != group[i])
+                        merge(group, Count, group[owner[Cell]], group[i]);
+                }
+            }
+        }
+    }
+    static void merge(int* group, int Count, int From, int To) {
+        // Groups are named after their smallest flood
+        if (From < To)
+            swap(From, To);
+        for (int i = 0; i < Count; i++)
+            if (group[i] == From)
+                group[i] = To;
+    }
+};
+
+/**
+ * @brief Hands out the neighbors of a node with the weight of the edge coming from the neighbor instead of going to it.
+ */
+template <typename GraphType>
+struct ReverseNeighborIterator {
+    typedef decltype(declval<const GraphType&>().adjacent(0).begin()) Inner;
+    Inner edge;
+    const GraphType* graph;
+    int node;
+    pair<int, int> operator*() const {
+        pair<int, int> NodeAndWeight = *edge;
+        return { NodeAndWeight.first, ReverseWeight(*graph, node, NodeAndWeight.first, NodeAndWeight.second) };
+    }
+    ReverseNeighborIterator& operator++() {
+        ++edge;
+        return *this;
+    }
+    bool operator!=(const ReverseNeighborIterator& Other) const { return edge != Other.edge; }
+};
+
+template <typename GraphType>
+struct ReverseNeighborRange {
+    ReverseNeighborIterator<GraphType> first, last;
+    ReverseNeighborIterator<GraphType> begin() const { return first; }
+    ReverseNeighborIterator<GraphType> end() const { return last; }
+};
+
+/**
+ * @brief A graph with every edge turned around, a search from a node on it gives the distances from all the nodes to that node.
+ */
+template <typename GraphType>
+struct ReverseGraph {
+    const GraphType& graph;
+    const vector<NodeState>& state;
+    explicit ReverseGraph(const GraphType& Graph) : graph(Graph), state(Graph.state) {}
+    ReverseNeighborRange<GraphType> adjacent(int Node) const {
+        auto Edges = graph.adjacent(Node);
+        return { { Edges.begin(), &graph, Node }, { Edges.end(), &graph, Node } };
+    }
+};
+
+/**
+ * @brief Distances from Landmark to every node (From) and from every node to Landmark (To), 0x7FFFFFFF where there is no path.
+ */
+template <typename GraphType>
+void LandmarkDistances(const GraphType& graph, int Landmark, SearchContext& context, vector<int>& From, vector<int>& To) {
+    const size_t NodeCount = graph.state.size();
+    From.assign(NodeCount, 0x7FFFFFFF);
+    To.assign(NodeCount, 0x7FFFFFFF);
+    SearchDijkstra(graph, context, Landmark, -1);
+    for (size_t Node = 0; Node < NodeCount; Node++)
+        From[Node] = context.get_distance((int)Node);
+    SearchDijkstra(ReverseGraph<GraphType>(graph), context, Landmark, -1);
+    for (size_t Node = 0; Node < NodeCount; Node++)
+        To[Node] = context.get_distance((int)Node);
+}
+
+/**
+ * @brief Landmarks for ALT picked one by one, each is the node farthest from the ones already picked.
+ *
+ * @param First Node to start from, the first landmark is the node farthest from it. -1 for the first node that isn't an obstacle.
+ * @return vector<int> Up to Count landmarks, fewer if the part of the map reachable from First runs out.
+ */
+template <typename GraphType>
+vector<int> FarthestLandmarks(const GraphType& graph, int Count, int First = -1) {
+    const int NodeCount = (int)graph.state.size();
+    vector<int> landmarks;
+    if (First == -1)
+        for (First = 0; First < NodeCount && graph.state[First] == Obstacle; First++);
+    if (First == NodeCount)
+        return landmarks;
+    SearchContext context;
+    vector<int> nearest(NodeCount, 0x7FFFFFFF); // Distance to the closest landmark
+    SearchDijkstra(graph, context, First, -1);
+    int Farthest = First;
+    for (int Node = 0; Node < NodeCount; Node++)
+        if (context.reached(Node) && context.distance[Node] > context.get_distance(Farthest))
+            Farthest = Node;
+    while ((int)landmarks.size() < Count) {
+        landmarks.push_back(Farthest);
+        SearchDijkstra(graph, context, Farthest, -1);
+        for (int Node = 0; Node < NodeCount; Node++)
+            if (context.reached(Node))
+                nearest[Node] = min(nearest[Node], context.distance[Node]);
+        for (int Node = 0; Node < NodeCount; Node++)
+            if (nearest[Node] != 0x7FFFFFFF && nearest[Node] > nearest[Farthest])
+                Farthest = Node;
+        if (nearest[Farthest] == 0)
+            break;
+    }
+    return landmarks;
+}
+
+/**
+ * @brief Landmarks for ALT picked with the avoid strategy (Goldberg and Werneck): grow a shortest path tree from a random node, weigh every node
+ * by how much the current landmarks underestimate its distance, and put the next landmark at the leaf of the heaviest branch without a landmark.
+ * Better spread than FarthestLandmarks on maps with walls, the landmarks end up behind the detours the bounds miss.
+ */
+template <typename GraphType>
+vector<int> AvoidLandmarks(const GraphType& graph, int Count) {
+    const int NodeCount = (int)graph.state.size();
+    vector<int> landmarks = FarthestLandmarks(graph, 1);
+    if (landmarks.empty())
+        return landmarks;
+    SearchContext context;
+    vector<vector<int>> from(1), to(1);
+    LandmarkDistances(graph, landmarks[0], context, from[0], to[0]);
+    vector<int> order;
+    vector<long long> size(NodeCount);
+    vector<int> heaviest(NodeCount);
+    for (int Attempt = 0; (int)landmarks.size() < Count && Attempt < 4 * Count; Attempt++) {
+        int Root = rand() % NodeCount;
+        if (graph.state[Root] == Obstacle)
+            continue;
+        SearchDijkstra(graph, context, Root, -1);
+        order.clear();
+        for (int Node = 0; Node < NodeCount; Node++)
+            if (context.reached(Node)) {
+                order.push_back(Node);
+                // The gap between the real distance and the best bound so far
+                int Bound = 0;
+                for (size_t k = 0; k < landmarks.size(); k++) {
+                    if (from[k][Root] != 0x7FFFFFFF && from[k][Node] != 0x7FFFFFFF)
+                        Bound = max(Bound, from[k][Node] - from[k][Root]);
+                    if (to[k][Root] != 0x7FFFFFFF && to[k][Node] != 0x7FFFFFFF)
+                        Bound = max(Bound, to[k][Root] - to[k][Node]);
+                }
+                size[Node] = context.distance[Node] - Bound;
+                heaviest[Node] = -1;
+            }
+        for (int Landmark : landmarks)
+            if (context.reached(Landmark))
+                size[Landmark] = -1;
+        // Children before parents, a branch with a landmark in it weighs nothing (-1 marks it) and is never followed
+        sort(order.begin(), order.end(), [&](int a, int b) { return context.distance[a] > context.distance[b]; });
+        for (int Node : order) {
+            int Parent = context.parent[Node];
+            if (Parent == -1)
+                continue;
+            if (size[Node] == -1) {
+                size[Parent] = -1;
+                continue;
+            }
+            if (size[Parent] != -1)
+                size[Parent] += size[Node];
+            if (heaviest[Parent] == -1 || size[Node] > size[heaviest[Parent]])
+                heaviest[Parent] = Node;
+        }
+        int Leaf = Root;
+        while (heaviest[Leaf] != -1)
+            Leaf = heaviest[Leaf];
+        // Nothing to gain when the bounds are already exact all the way down
+        if (size[Leaf] <= 0)
+            continue;
+        landmarks.push_back(Leaf);
+        from.push_back(vector<int>());
+        to.push_back(vector<int>());
+        LandmarkDistances(graph, Leaf, context, from.back(), to.back());
+    }
+    return landmarks;
+}
+
+/**
+ * @brief Distances between every node and a few landmarks, for the ALT lower bounds of LandmarkHeuristic.
+ * The distances of one node to all the landmarks are next to each other, a bound reads one short row. They are stored in 16 bits when the largest
+ * one fits, which halves the memory on large maps.
+ */
+struct LandmarkTable {
+    vector<int>landmarks;
+    bool compact = false;
+    vector<unsigned short>table16; // [Node * 2 * landmarks + 2 * k] from landmark k to Node, + 1 from Node to landmark k, 0xFFFF where there is no path
+    vector<int>table32; // Same when a distance doesn't fit 16 bits, 0x7FFFFFFF where there is no path
+
+    /**
+     * @brief Computes the tables with Dijkstra from (and to) every landmark.
+     */
+    template <typename GraphType>
+    void build(const GraphType& graph, const vector<int>& Landmarks) {
+        const size_t NodeCount = graph.state.size(), Count = Landmarks.size();
+        landmarks = Landmarks;
+        vector<vector<int>> from(Count), to(Count);
+        SearchContext context;
+        int Largest = 0;
+        for (size_t k = 0; k < Count; k++) {
+            LandmarkDistances(graph, Landmarks[k], context, from[k], to[k]);
+            for (size_t Node = 0; Node < NodeCount; Node++) {
+                if (from[k][Node] != 0x7FFFFFFF)
+                    Largest = max(Largest, from[k][Node]);
+                if (to[k][Node] != 0x7FFFFFFF)
+                    Largest = max(Largest, to[k][Node]);
+            }
+        }
+        compact = Largest < 0xFFFF;
+        table16.clear();
+        table32.clear();
+        if (compact)
+            fill_table(table16, from, to, (unsigned short)0xFFFF);
+        else
+            fill_table(table32, from, to, 0x7FFFFFFF);
+    }
+    /**
+     * @brief Lower bound on the distance from Node to EndNode by the triangle inequality, d(L, End) - d(L, Node) and d(Node, L) - d(End, L).
+     */
+    int lower_bound(int Node, int EndNode) const {
+        const size_t Row = 2 * landmarks.size();
+        if (compact)
+            return bound(table16.data() + Node * Row, table16.data() + EndNode * Row, (unsigned short)0xFFFF);
+        return bound(table32.data() + Node * Row, table32.data() + EndNode * Row, 0x7FFFFFFF);
+    }
+
+private:
+    template <typename T>
+    void fill_table(vector<T>& table, const vector<vector<int>>& from, const vector<vector<int>>& to, T Unreached) {
+        const size_t Count = from.size(), NodeCount = Count ? from[0].size() : 0;
+        table.resize(NodeCount * 2 * Count);
+        for (size_t Node = 0; Node < NodeCount; Node++)
+            for (size_t k = 0; k < Count; k++) {
+                table[(Node * Count + k) * 2] = from[k][Node] == 0x7FFFFFFF ? Unreached : (T)from[k][Node];
+                table[(Node * Count + k) * 2 + 1] = to[k][Node] == 0x7FFFFFFF ? Unreached : (T)to[k][Node];
+            }
+    }
+    template <typename T>
+    int bound(const T* Row, const T* EndRow, T Unreached) const {
+        int Bound = 0;
+        for (size_t i = 0; i < 2 * landmarks.size(); i += 2) {
+            if (Row[i] != Unreached && EndRow[i] != Unreached)
+                Bound = max(Bound, (int)EndRow[i] - (int)Row[i]);
+            if (Row[i + 1] != Unreached && EndRow[i + 1] != Unreached)
+                Bound = max(Bound, (int)Row[i + 1] - (int)EndRow[i + 1]);
+        }
+        return Bound;
+    }
+};
+
+/**
+ * @brief ALT heuristic for AStar and SearchAStar, the best landmark bound of a LandmarkTable built for the same map.
+ */
+struct LandmarkHeuristic {
+    const LandmarkTable* table;
+    int operator()(int Node, int EndNode) const {
+        return table->lower_bound(Node, EndNode);
+    }
+};
+
+/**
+ * @brief Dijkstra (or A* towards Goal) that stays inside the rectangle [Left, Right] x [Top, Bottom] of the map, for the clusters of HierarchicalGrid.
+ * Backward walks the edges the other way, context.distance is then the cost of going from a node to Source.
+ *
+ * @param Goal Stops when it is reached, -1 to search the whole rectangle.
+ * @return int 1 if Goal was reached.
+ */
+int ClusterSearch(const GridMap& map, SearchContext& context, int Source, int Goal, int Left, int Top, int Right, int Bottom, bool Backward = false) {
+    vector<pair<int, int>>& heap = context.heap;
+    ManhattanHeuristic heuristic = { map.width };
+    context.begin(map.state.size());
+    context.reach(Source, 0, -1);
+    heap.push_back(make_pair(Goal == -1 ? 0 : -heuristic(Source, Goal), -Source));
+    while (!heap.empty()) {
+        int Estimate = -heap.front().first;
+        int Parent = -heap.front().second;
+        if (Parent == Goal) {
+            context.found = 1;
+            break;
+        }
+        pop_heap(heap.begin(), heap.end());
+        heap.pop_back();
+        int Distance = context.distance[Parent];
+        if (Estimate - (Goal == -1 ? 0 : heuristic(Parent, Goal)) > Distance)
+            continue;
+        for (pair<int, int> NodeAndWeight : map.adjacent(Parent)) {
+            int Node = NodeAndWeight.first;
+            int x = Node % map.width, y = Node / map.width;
+            if (x < Left || x > Right || y < Top || y > Bottom || map.state[Node] == Obstacle)
+                continue;
+            int NetWeight = Distance + (Backward ? map.cost[Parent] : NodeAndWeight.second);
+            if (NetWeight < context.get_distance(Node)) {
+                context.reach(Node, NetWeight, Parent);
+                heap.push_back(make_pair(-(NetWeight + (Goal == -1 ? 0 : heuristic(Node, Goal))), -Node));
+                push_heap(heap.begin(), heap.end());
+            }
+        }
+    }
+    return context.found;
+}
+
+/**
+ * @brief HPA*, the grid cut into ClusterSize x ClusterSize clusters with an abstract graph on top.
+ * Every open stretch of a border between two clusters gets one or two entrances (a pair of cells facing each other). Inside a cluster the
+ * entrances are joined by their shortest in-cluster distance, computed once. A query only adds the start and the goal to the abstract graph,
+ * searches it (a few entrances per cluster instead of every cell), and the abstract path is turned into cells one segment at a time with refine.
+ * The paths are close to the shortest, not always the shortest, since the way between clusters goes through the entrances.
+ * After the map changes, update_cell marks the clusters (and borders) of the changed cells and only those are rebuilt before the next query.
+ */
+struct HierarchicalGrid {
+    struct Cluster {
+        vector<int>entrances; // Cells, sorted
+        vector<vector<int>>partners; // Cells of other clusters each entrance leads to
+        vector<int>costs; // costs[i * entrances.size() + j], in-cluster distance from entrance i to entrance j
+        bool dirty = true;
+    };
+    const GridMap* map = nullptr;
+    int clusterSize = 0, clustersX = 0, clustersY = 0;
+    vector<Cluster>clusters;
+    vector<vector<pair<int, int>>>verticalBorders; // Border between (cx, cy) and (cx + 1, cy), (left cell, right cell) of every entrance
+    vector<vector<pair<int, int>>>horizontalBorders; // Border between (cx, cy) and (cx, cy + 1), (upper cell, lower cell) of every entrance
+    vector<char>dirtyVertical, dirtyHorizontal;
+    SearchContext context; // For the searches inside a cluster
+
+    /**
+     * @brief Cuts Map into clusters and builds everything, the map has to stay alive as long as this is used.
+     */
+    void build(const GridMap& Map, int ClusterSize = 16) {
+        map = &Map;
+        clusterSize = ClusterSize;
+        clustersX = (Map.width + ClusterSize - 1) / ClusterSize;
+        clustersY = (Map.height + ClusterSize - 1) / ClusterSize;
+        clusters.assign(clustersX * clustersY, Cluster());
+        verticalBorders.assign(max(0, clustersX - 1) * clustersY, vector<pair<int, int>>());
+        horizontalBorders.assign(clustersX * max(0, clustersY - 1), vector<pair<int, int>>());
+        dirtyVertical.assign(verticalBorders.size(), 1);
+        dirtyHorizontal.assign(horizontalBorders.size(), 1);
+        refresh();
+    }
+    /**
+     * @brief Has to be called for every cell whose state or cost changed, the clusters it touches are rebuilt before the next query.
+     */
+    void update_cell(int Node) {
+        int x = Node % map->width, y = Node / map->width;
+        int cx = x / clusterSize, cy = y / clusterSize;
+        clusters[cy * clustersX + cx].dirty = true;
+        if (x % clusterSize == 0 && cx > 0)
+            mark_vertical(cx - 1, cy);
+        if ((x % clusterSize == clusterSize - 1 || x == map->width - 1) && cx < clustersX - 1)
+            mark_vertical(cx, cy);
+        if (y % clusterSize == 0 && cy > 0)
+            mark_horizontal(cx, cy - 1);
+        if ((y % clusterSize == clusterSize - 1 || y == map->height - 1) && cy < clustersY - 1)
+            mark_horizontal(cx, cy);
+    }
+    /**
+     * @brief Rebuilds the borders and clusters that changed since the last call.
+     */
+    void refresh() {
+        for (int cy = 0; cy < clustersY; cy++)
+            for (int cx = 0; cx < clustersX; cx++) {
+                if (cx < clustersX - 1 && dirtyVertical[cy * (clustersX - 1) + cx])
+                    build_border(cx, cy, true);
+                if (cy < clustersY - 1 && dirtyHorizontal[cy * clustersX + cx])
+                    build_border(cx, cy, false);
+            }
+        for (int c = 0; c < (int)clusters.size(); c++)
+            if (clusters[c].dirty)
+                build_cluster(c);
+    }
+    /**
+     * @brief Searches the abstract graph.
+     *
+     * @return vector<int> Waypoints from Source to Goal (both included), every two following ones are in the same cluster or next to each other. Empty if there is no path.
+     */
+    vector<int> abstract_path(int Source, int Goal) {
+        refresh();
+        vector<int> waypoints;
+        if (map->state[Source] == Obstacle || map->state[Goal] == Obstacle)
+            return waypoints;
+        if (Source == Goal)
+            return vector<int>(1, Source);
+
+        // Start and goal are joined to the entrances of their clusters
+        int SourceCluster = cluster_of(Source), GoalCluster = cluster_of(Goal);
+        vector<pair<int, int>> sourceEdges, goalEdges; // (entrance, cost)
+        cluster_search(SourceCluster, Source, -1, false);
+        for (int Entrance : clusters[SourceCluster].entrances)
+            if (context.reached(Entrance))
+                sourceEdges.push_back(make_pair(Entrance, context.distance[Entrance]));
+        if (SourceCluster == GoalCluster && context.reached(Goal))
+            sourceEdges.push_back(make_pair(Goal, context.distance[Goal]));
+        cluster_search(GoalCluster, Goal, -1, true);
+        for (int Entrance : clusters[GoalCluster].entrances)
+            if (context.reached(Entrance))
+                goalEdges.push_back(make_pair(Entrance, context.distance[Entrance]));
+
+        // A* over the abstract nodes, the context is keyed by cell so it serves the abstract graph too
+        ManhattanHeuristic heuristic = { map->width };
+        vector<pair<int, int>>& heap = context.heap;
+        context.begin(map->state.size());
+        context.reach(Source, 0, -1);
+        heap.push_back(make_pair(-heuristic(Source, Goal), -Source));
+        auto Relax = [&](int From, int To, int Weight) {
+            int NetWeight = context.distance[From] + Weight;
+            if (NetWeight < context.get_distance(To)) {
+                context.reach(To, NetWeight, From);
+                heap.push_back(make_pair(-(NetWeight + heuristic(To, Goal)), -To));
+                push_heap(heap.begin(), heap.end());
+            }
+        };
+        while (!heap.empty()) {
+            int Estimate = -heap.front().first;
+            int Node = -heap.front().second;
+            if (Node == Goal)
+                break;
+            pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+            if (Estimate - heuristic(Node, Goal) > context.distance[Node])
+                continue;
+            if (Node == Source)
+                for (const pair<int, int>& Edge : sourceEdges)
+                    Relax(Node, Edge.first, Edge.second);
+            int c = cluster_of(Node);
+            const Cluster& cluster = clusters[c];
+            vector<int>::const_iterator Found = lower_bound(cluster.entrances.begin(), cluster.entrances.end(), Node);
+            if (Found != cluster.entrances.end() && *Found == Node) {
+                size_t i = Found - cluster.entrances.begin(), Count = cluster.entrances.size();
+                for (size_t j = 0; j < Count; j++)
+                    if (j != i && cluster.costs[i * Count + j] != 0x7FFFFFFF)
+                        Relax(Node, cluster.entrances[j], cluster.costs[i * Count + j]);
+                for (int Partner : cluster.partners[i])
+                    Relax(Node, Partner, map->cost[Partner]);
+                if (c == GoalCluster)
+                    for (const pair<int, int>& Edge : goalEdges)
+                        if (Edge.first == Node)
+                            Relax(Node, Goal, Edge.second);
+            }
+        }
+        if (!context.reached(Goal))
+            return waypoints;
+        for (int Node = Goal; Node != -1; Node = context.parent[Node])
+            waypoints.push_back(Node);
+        reverse(waypoints.begin(), waypoints.end());
+        return waypoints;
+    }
+    /**
+     * @brief Cells from waypoint Segment to waypoint Segment + 1, without the first and with the last like GetPath.
+     */
+    vector<int> refine(const vector<int>& Waypoints, size_t Segment) {
+        int From = Waypoints[Segment], To = Waypoints[Segment + 1];
+        int c = cluster_of(From);
+        if (c != cluster_of(To))
+            return vector<int>(1, To);
+        cluster_search(c, From, To, false);
+        return GetSearchPath(context, To, From);
+    }
+    /**
+     * @brief The whole path like GetPath gives it (without Source, with Goal), empty if there is none.
+     */
+    vector<int> find_path(int Source, int Goal) {
+        vector<int> waypoints = abstract_path(Source, Goal), path;
+        for (size_t Segment = 0; Segment + 1 < waypoints.size(); Segment++) {
+            vector<int> part = refine(waypoints, Segment);
+            path.insert(path.end(), part.begin(), part.end());
+        }
+        return path;
+    }
+
+private:
+    int cluster_of(int Node) const {
+        return (Node / map->width / clusterSize) * clustersX + (Node % map->width) / clusterSize;
+    }
+    void cluster_search(int c, int Source, int Goal, bool Backward) {
+        int Left = (c % clustersX) * clusterSize, Top = (c / clustersX) * clusterSize;
+        ClusterSearch(*map, context, Source, Goal, Left, Top, min(Left + clusterSize, map->width) - 1, min(Top + clusterSize, map->height) - 1, Backward);
+    }
+    void mark_vertical(int cx, int cy) {
+        dirtyVertical[cy * (clustersX - 1) + cx] = 1;
+        clusters[cy * clustersX + cx].dirty = clusters[cy * clustersX + cx + 1].dirty = true;
+    }
+    void mark_horizontal(int cx, int cy) {
+        dirtyHorizontal[cy * clustersX + cx] = 1;
+        clusters[cy * clustersX + cx].dirty = clusters[(cy + 1) * clustersX + cx].dirty = true;
+    }
+    /**
+     * @brief Finds the entrances of the border after cluster (cx, cy), to the right (Vertical) or below it.
+     */
+    void build_border(int cx, int cy, bool Vertical) {
+        vector<pair<int, int>>& border = Vertical ? verticalBorders[cy * (clustersX - 1) + cx] : horizontalBorders[cy * clustersX + cx];
+        (Vertical ? dirtyVertical[cy * (clustersX - 1) + cx] : dirtyHorizontal[cy * clustersX + cx]) = 0;
+        border.clear();
+        // Cells along the border on the first side, Step goes to the facing cell
+        int First = Vertical ? (cy * clusterSize) * map->width + (cx + 1) * clusterSize - 1 : ((cy + 1) * clusterSize - 1) * map->width + cx * clusterSize;
+        int Along = Vertical ? map->width : 1;
+        int Step = Vertical ? 1 : map->width;
+        int Length = Vertical ? min(clusterSize, map->height - cy * clusterSize) : min(clusterSize, map->width - cx * clusterSize);
+        for (int i = 0; i < Length; ) {
+            int Cell = First + i * Along;
+            if (map->state[Cell] == Obstacle || map->state[Cell + Step] == Obstacle) {
+                i++;
+                continue;
+            }
+            int RunStart = i;
+            while (i < Length && map->state[First + i * Along] != Obstacle && map->state[First + i * Along + Step] != Obstacle)
+                i++;
+            // Short stretches get one entrance in the middle, long ones one at each end
+            if (i - RunStart < 6) {
+                int Middle = First + ((RunStart + i - 1) / 2) * Along;
+                border.push_back(make_pair(Middle, Middle + Step));
+            }
+            else {
+                int Begin = First + RunStart * Along, End = First + (i - 1) * Along;
+                border.push_back(make_pair(Begin, Begin + Step));
+                border.push_back(make_pair(End, End + Step));
+            }
+        }
+    }
+    /**
+     * @brief Collects the entrances of cluster c from its four borders and computes the in-cluster distances between them.
+     */
+    void build_cluster(int c) {
+        Cluster& cluster = clusters[c];
+        int cx = c % clustersX, cy = c / clustersX;
+        vector<pair<int, int>> links; // (entrance in this cluster, cell on the other side)
+        if (cx > 0)
+            for (const pair<int, int>& Link : verticalBorders[cy * (clustersX - 1) + cx - 1])
+                links.push_back(make_pair(Link.second, Link.first));
+        if (cx < clustersX - 1)
+            for (const pair<int, int>& Link : verticalBorders[cy * (clustersX - 1) + cx])
+                links.push_back(Link);
+        if (cy > 0)
+            for (const pair<int, int>& Link : horizontalBorders[(cy - 1) * clustersX + cx])
+                links.push_back(make_pair(Link.second, Link.first));
+        if (cy < clustersY - 1)
+            for (const pair<int, int>& Link : horizontalBorders[cy * clustersX + cx])
+                links.push_back(Link);
+        sort(links.begin(), links.end());
+
+        cluster.entrances.clear();
+        cluster.partners.clear();
+        for (const pair<int, int>& Link : links) {
+            if (cluster.entrances.empty() || cluster.entrances.back() != Link.first) {
+                cluster.entrances.push_back(Link.first);
+                cluster.partners.push_back(vector<int>());
+            }
+            cluster.partners.back().push_back(Link.second);
+        }
+        size_t Count = cluster.entrances.size();
+        cluster.costs.assign(Count * Count, 0x7FFFFFFF);
+        for (size_t i = 0; i < Count; i++) {
+            cluster_search(c, cluster.entrances[i], -1, false);
+            for (size_t j = 0; j < Count; j++)
+                if (context.reached(cluster.entrances[j]))
+                    cluster.costs[i * Count + j] = context.distance[cluster.entrances[j]];
+        }
+        cluster.dirty = false;
+    }
+};
+
+/**
+ * @brief Search state of one ContractionHierarchy query, every thread asking queries needs its own.
+ */
+struct ContractionSearch {
+    SearchContext forward, backward;
+    int meet = -1; // Node where the two searches met on the shortest path
+    int distance = 0x7FFFFFFF;
+};
+
+/**
+ * @brief Contraction Hierarchies, a preprocessing for fast point to point queries on a map that doesn't change.
+ * The nodes are taken out (contracted) one by one, least important first. Whenever a shortest path went through a contracted node, a shortcut
+ * edge that skips it is added between its neighbors. A query is then a bidirectional Dijkstra that only goes up to nodes contracted later,
+ * which looks at a few hundred nodes instead of the whole map, and the shortcuts on the path are unpacked back into the nodes they skip.
+ * Any change of the map (obstacles or costs) needs a new build.
+ */
+struct ContractionHierarchy {
+    struct Edge {
+        int node;
+        int weight;
+        int middle; // Node the shortcut skips, -1 for an edge of the graph
+    };
+    vector<int>rank; // Order in which the nodes were contracted
+    vector<int>up_offsets; // Edges of node i are in [up_offsets[i], up_offsets[i + 1]), like CsrGraph
+    vector<Edge>up; // Edges from a node to higher ranked nodes
+    vector<int>down_offsets;
+    vector<Edge>down; // Edges into a node from higher ranked nodes, node is where the edge comes from
+
+    /**
+     * @brief Contracts every node of graph and builds the up and down graphs, obstacles are left out.
+     *
+     * @param graph Graph, CsrGraph, GridGraph or GridMap, edge weights are taken from graph.adjacent.
+     */
+    template <typename GraphType>
+    void build(const GraphType& graph) {
+        const int NodeCount = (int)graph.state.size();
+        // The graph that is left, edges to contracted nodes are removed as they go
+        vector<vector<Edge>> out(NodeCount), in(NodeCount);
+        for (int Node = 0; Node < NodeCount; Node++)
+            if (graph.state[Node] != Obstacle)
+                for (pair<int, int> NodeAndWeight : graph.adjacent(Node))
+                    if (graph.state[NodeAndWeight.first] != Obstacle && NodeAndWeight.first != Node)
+                        add_edge(out, in, Node, NodeAndWeight.first, NodeAndWeight.second, -1);
+
+        vector<vector<Edge>> upEdges(NodeCount), downEdges(NodeCount);
+        vector<char> contracted(NodeCount, 0);
+        vector<int> deletedNeighbors(NodeCount, 0);
+        vector<pair<int, pair<int, int>>> shortcuts; // (from, (to, weight))
+        SearchContext witness;
+        rank.assign(NodeCount, 0);
+        int NextRank = 0;
+        typedef pair<int, int> pairOfInt;
+        priority_queue<pairOfInt, vector<pairOfInt>, greater<pairOfInt>> que;
+        for (int Node = 0; Node < NodeCount; Node++) {
+            if (graph.state[Node] == Obstacle) {
+                rank[Node] = NextRank++;
+                contracted[Node] = 1;
+                continue;
+            }
+            find_shortcuts(out, in, contracted, witness, Node, shortcuts);
+            que.push(make_pair(priority(out, in, deletedNeighbors, Node, shortcuts.size()), Node));
+        }
+
+        while (!que.empty()) {
+            int Node = que.top().second;
+            que.pop();
+            // The priority is only recomputed when the node comes up, if it went up it waits for its turn again
+            find_shortcuts(out, in, contracted, witness, Node, shortcuts);
+            int Priority = priority(out, in, deletedNeighbors, Node, shortcuts.size());
+            if (!que.empty() && Priority > que.top().first) {
+                que.push(make_pair(Priority, Node));
+                continue;
+            }
+
+            rank[Node] = NextRank++;
+            contracted[Node] = 1;
+            upEdges[Node] = out[Node];
+            downEdges[Node] = in[Node];
+            for (const Edge& Out : out[Node]) {
+                remove_edge(in[Out.node], Node);
+                deletedNeighbors[Out.node]++;
+            }
+            for (const Edge& In : in[Node]) {
+                remove_edge(out[In.node], Node);
+                deletedNeighbors[In.node]++;
+            }
+            for (const pair<int, pair<int, int>>& Shortcut : shortcuts)
+                add_edge(out, in, Shortcut.first, Shortcut.second.first, Shortcut.second.second, Node);
+            vector<Edge>().swap(out[Node]);
+            vector<Edge>().swap(in[Node]);
+        }
+
+        to_csr(upEdges, up_offsets, up);
+        to_csr(downEdges, down_offsets, down);
+    }
+
+    /**
+     * @brief Shortest distance from Source to Target, search.meet and search.distance are set for unpack.
+     *
+     * @return int 1 if Target can be reached.
+     */
+    int query(ContractionSearch& search, int Source, int Target) const {
+        const size_t NodeCount = rank.size();
+        SearchContext& forward = search.forward;
+        SearchContext& backward = search.backward;
+        forward.begin(NodeCount);
+        backward.begin(NodeCount);
+        forward.reach(Source, 0, -1);
+        backward.reach(Target, 0, -1);
+        forward.heap.push_back(make_pair(0, -Source));
+        backward.heap.push_back(make_pair(0, -Target));
+        search.meet = -1;
+        search.distance = 0x7FFFFFFF;
+        while (true) {
+            // The side with the closer node goes on, until neither can beat the best meeting found
+            int ForwardTop = forward.heap.empty() ? 0x7FFFFFFF : -forward.heap.front().first;
+            int BackwardTop = backward.heap.empty() ? 0x7FFFFFFF : -backward.heap.front().first;
+            if (min(ForwardTop, BackwardTop) >= search.distance)
+                break;
+            bool Forward = ForwardTop <= BackwardTop;
+            SearchContext& side = Forward ? forward : backward;
+            const SearchContext& other = Forward ? backward : forward;
+            int Distance = -side.heap.front().first;
+            int Parent = -side.heap.front().second;
+            pop_heap(side.heap.begin(), side.heap.end());
+            side.heap.pop_back();
+            if (Distance > side.distance[Parent])
+                continue;
+            if (other.reached(Parent) && Distance + other.distance[Parent] < search.distance) {
+                search.distance = Distance + other.distance[Parent];
+                search.meet = Parent;
+            }
+            const vector<int>& offsets = Forward ? up_offsets : down_offsets;
+            const vector<Edge>& edges = Forward ? up : down;
+            // Stall on demand: a higher node reached by this side already has a shorter way here, nothing above can be on a shortest path
+            const vector<int>& otherOffsets = Forward ? down_offsets : up_offsets;
+            const vector<Edge>& otherEdges = Forward ? down : up;
+            bool Stalled = false;
+            for (int i = otherOffsets[Parent]; i < otherOffsets[Parent + 1] && !Stalled; i++)
+                Stalled = side.get_distance(otherEdges[i].node) < Distance - otherEdges[i].weight;
+            if (Stalled)
+                continue;
+            for (int i = offsets[Parent]; i < offsets[Parent + 1]; i++) {
+                int NetWeight = Distance + edges[i].weight;
+                if (NetWeight < side.get_distance(edges[i].node)) {
+                    side.reach(edges[i].node, NetWeight, Parent);
+                    side.heap.push_back(make_pair(-NetWeight, -edges[i].node));
+                    push_heap(side.heap.begin(), side.heap.end());
+                }
+            }
+        }
+        forward.found = backward.found = search.meet != -1;
+        return forward.found;
+    }
+
+    /**
+     * @brief The path of the last query with the shortcuts unpacked, like GetPath gives it (without Source, with Target).
+     */
+    vector<int> unpack(const ContractionSearch& search, int Source, int Target) const {
+        vector<int> path;
+        if (search.meet == -1)
+            return path;
+        // Up from Source to the meeting node, then down to Target
+        vector<int> climb;
+        for (int Node = search.meet; Node != Source; Node = search.forward.parent[Node])
+            climb.push_back(Node);
+        int From = Source;
+        for (size_t i = climb.size(); i-- > 0; From = climb[i])
+            unpack_edge(From, climb[i], path);
+        for (int Node = search.meet; Node != Target; Node = search.backward.parent[Node])
+            unpack_edge(Node, search.backward.parent[Node], path);
+        return path;
+    }
+
+    /**
+     * @brief Writes the preprocessed hierarchy to a binary file.
+     *
+     * @return bool false if the file couldn't be written.
+     */
+    bool save(const string& FileName) const {
+        ofstream file(FileName, ios::binary);
+        if (!file)
+            return false;
+        file.write("CH01", 4);
+        write_array(file, rank);
+        write_array(file, up_offsets);
+        write_array(file, up);
+        write_array(file, down_offsets);
+        write_array(file, down);
+        return (bool)file;
+    }
+    /**
+     * @brief Reads a hierarchy written by save, it must have been built for the same map.
+     *
+     * @return bool false if the file couldn't be read or isn't a whole saved hierarchy, the hierarchy is empty then.
+     */
+    bool load(const string& FileName) {
+        ifstream file(FileName, ios::binary);
+        char Magic[4] = {};
+        bool Read = file.read(Magic, 4) && string(Magic, 4) == "CH01" && read_array(file, rank) && read_array(file, up_offsets) && read_array(file, up)
+                    && read_array(file, down_offsets) && read_array(file, down) && file.peek() == EOF;
+        if (Read && valid())
+            return true;
+        rank.clear();
+        up_offsets.clear();
+        up.clear();
+        down_offsets.clear();
+        down.clear();
+        return false;
+    }
+
+private:
+    static void add_edge(vector<vector<Edge>>& out, vector<vector<Edge>>& in, int From, int To, int Weight, int Middle) {
+        // Only the shortest edge between two nodes is kept
+        for (Edge& Existing : out[From])
+            if (Existing.node == To) {
+                if (Weight < Existing.weight) {
+                    Existing.weight = Weight;
+                    Existing.middle = Middle;
+                    for (Edge& Back : in[To])
+                        if (Back.node == From) {
+                            Back.weight = Weight;
+                            Back.middle = Middle;
+                        }
+                }
+                return;
+            }
+        out[From].push_back({ To, Weight, Middle });
+        in[To].push_back({ From, Weight, Middle });
+    }
+    static void remove_edge(vector<Edge>& edges, int Node) {
+        for (size_t i = 0; i < edges.size(); i++)
+            if (edges[i].node == Node) {
+                edges[i] = edges.back();
+                edges.pop_back();
+                return;
+            }
+    }
+    /**
+     * @brief Shortcuts needed if Node is contracted now: u -> Node -> x needs one unless a witness path u -> x without Node is as short.
+     * The witness search gives up after a hundred nodes, that only costs an extra shortcut.
+     */
+    static void find_shortcuts(const vector<vector<Edge>>& out, const vector<vector<Edge>>& in, const vector<char>& contracted, SearchContext& witness,
+                               int Node, vector<pair<int, pair<int, int>>>& shortcuts) {
+        shortcuts.clear();
+        for (const Edge& In : in[Node]) {
+            int Limit = 0;
+            for (const Edge& Out : out[Node])
+                if (Out.node != In.node)
+                    Limit = max(Limit, In.weight + Out.weight);
+            if (Limit == 0)
+                continue;
+            witness.begin(out.size());
+            witness.reach(In.node, 0, -1);
+            witness.heap.push_back(make_pair(0, -In.node));
+            for (int Settled = 0; !witness.heap.empty() && Settled < 100; Settled++) {
+                int Distance = -witness.heap.front().first;
+                int Parent = -witness.heap.front().second;
+                pop_heap(witness.heap.begin(), witness.heap.end());
+                witness.heap.pop_back();
+                if (Distance > Limit)
+                    break;
+                if (Distance > witness.distance[Parent])
+                    continue;
+                for (const Edge& Next : out[Parent]) {
+                    int NetWeight = Distance + Next.weight;
+                    if (Next.node != Node && !contracted[Next.node] && NetWeight < witness.get_distance(Next.node)) {
+                        witness.reach(Next.node, NetWeight, Parent);
+                        witness.heap.push_back(make_pair(-NetWeight, -Next.node));
+                        push_heap(witness.heap.begin(), witness.heap.end());
+                    }
+                }
+            }
+            for (const Edge& Out : out[Node])
+                if (Out.node != In.node && witness.get_distance(Out.node) > In.weight + Out.weight)
+                    shortcuts.push_back(make_pair(In.node, make_pair(Out.node, In.weight + Out.weight)));
+        }
+    }
+    /**
+     * @brief Nodes that add few shortcuts for the edges they remove go first, the neighbor count spreads the contraction over the map.
+     */
+    static int priority(const vector<vector<Edge>>& out, const vector<vector<Edge>>& in, const vector<int>& deletedNeighbors, int Node, size_t Shortcuts) {
+        return 2 * ((int)Shortcuts - (int)out[Node].size() - (int)in[Node].size()) + deletedNeighbors[Node];
+    }
+    static void to_csr(const vector<vector<Edge>>& lists, vector<int>& offsets, vector<Edge>& edges) {
+        offsets.assign(lists.size() + 1, 0);
+        for (size_t Node = 0; Node < lists.size(); Node++)
+            offsets[Node + 1] = offsets[Node] + (int)lists[Node].size();
+        edges.clear();
+        edges.reserve(offsets.back());
+        for (const vector<Edge>& List : lists)
+            edges.insert(edges.end(), List.begin(), List.end());
+    }
+    static const Edge* find_edge(const vector<int>& offsets, const vector<Edge>& edges, int Node, int Other) {
+        for (int i = offsets[Node]; i < offsets[Node + 1]; i++)
+            if (edges[i].node == Other)
+                return &edges[i];
+        return nullptr;
+    }
+    /**
+     * @brief Checks everything query and unpack rely on, so a file that was cut short or changed can't make them read out of bounds:
+     * the ranks are a permutation, the offsets cover their edge arrays, edges go to existing nodes and up (down) edges go to higher
+     * ranked nodes, and the middle of a shortcut is ranked below both ends and has the two edges it is unpacked into.
+     */
+    bool valid() const {
+        const int NodeCount = (int)rank.size();
+        vector<char> used(NodeCount, 0);
+        for (int Rank : rank) {
+            if (Rank < 0 || Rank >= NodeCount || used[Rank])
+                return false;
+            used[Rank] = 1;
+        }
+        for (int Direction = 0; Direction < 2; Direction++) {
+            const vector<int>& offsets = Direction == 0 ? up_offsets : down_offsets;
+            const vector<Edge>& edges = Direction == 0 ? up : down;
+            if (offsets.size() != (size_t)NodeCount + 1 || offsets[0] != 0 || offsets[NodeCount] != (int)edges.size())
+                return false;
+            for (int Node = 0; Node < NodeCount; Node++)
+                if (offsets[Node] > offsets[Node + 1])
+                    return false;
+        }
+        for (int Direction = 0; Direction < 2; Direction++) {
+            const vector<int>& offsets = Direction == 0 ? up_offsets : down_offsets;
+            const vector<Edge>& edges = Direction == 0 ? up : down;
+            for (int Node = 0; Node < NodeCount; Node++)
+                for (int i = offsets[Node]; i < offsets[Node + 1]; i++) {
+                    const Edge& edge = edges[i];
+                    if (edge.node < 0 || edge.node >= NodeCount || rank[edge.node] <= rank[Node] || edge.weight < 0)
+                        return false;
+                    if (edge.middle == -1)
+                        continue;
+                    // Up edges go Node -> edge.node, down edges edge.node -> Node
+                    int Tail = Direction == 0 ? Node : edge.node, Head = Direction == 0 ? edge.node : Node;
+                    if (edge.middle < 0 || edge.middle >= NodeCount || rank[edge.middle] >= rank[Node]
+                        || !find_edge(down_offsets, down, edge.middle, Tail) || !find_edge(up_offsets, up, edge.middle, Head))
+                        return false;
+                }
+        }
+        return true;
+    }
+    /**
+     * @brief Appends the nodes of the edge From -> To after From, a shortcut u -> x over v was stored as u -> v (down edge of v) and v -> x (up edge of v).
+     */
+    void unpack_edge(int From, int To, vector<int>& path) const {
+        vector<pair<int, int>> edges(1, make_pair(From, To));
+        while (!edges.empty()) {
+            int Tail = edges.back().first, Head = edges.back().second;
+            edges.pop_back();
+            const Edge* edge = rank[Tail] < rank[Head] ? find_edge(up_offsets, up, Tail, Head) : find_edge(down_offsets, down, Head, Tail);
+            if (edge->middle == -1)
+                path.push_back(Head);
+            else {
+                edges.push_back(make_pair(edge->middle, Head));
+                edges.push_back(make_pair(Tail, edge->middle));
+            }
+        }
+    }
+    template <typename T>
+    static void write_array(ofstream& file, const vector<T>& array) {
+        unsigned long long Size = array.size();
+        file.write((const char*)&Size, sizeof(Size));
+        file.write((const char*)array.data(), Size * sizeof(T));
+    }
+    template <typename T>
+    static bool read_array(ifstream& file, vector<T>& array) {
+        unsigned long long Size = 0;
+        if (!file.read((char*)&Size, sizeof(Size)))
+            return false;
+        // A broken size must not allocate more than the rest of the file holds
+        streampos Here = file.tellg();
+        file.seekg(0, ios::end);
+        unsigned long long Left = (unsigned long long)(file.tellg() - Here);
+        file.seekg(Here);
+        if (Size > Left / sizeof(T))
+            return false;
+        array.resize((size_t)Size);
+        return (bool)file.read((char*)array.data(), Size * sizeof(T));
+    }
+};
+
+/**
+ * @brief D* Lite, a search from the goal back to the start that keeps its results between changes of the map.
+ * After cells of the map change (obstacles painted or removed, costs changed) update_cell is called for them and compute only repairs
+ * the part of the search the change made inconsistent, instead of searching again from nothing.
+ * g[Node] is the distance from Node to the goal, going into a cell costs its cost like everywhere else.
+ */
+struct DStarLite {
+    typedef pair<int, int> Key;
+    static const int Infinity = 0x3FFFFFFF;
+    const GridMap* map = nullptr;
+    int start = -1, goal = -1;
+    int km = 0; // Grows when the start moves, so the old keys stay valid
+    vector<int>g, rhs; // rhs is the one step lookahead of g, a node is consistent when both are equal
+    vector<Key>queuedKey; // Key the node is in the queue with
+    vector<char>inQueue;
+    priority_queue<pair<Key, int>, vector<pair<Key, int>>, greater<pair<Key, int>>>que; // May hold old entries, they are skipped
+    vector<int>touched; // Nodes expanded by the last compute
+
+    /**
+     * @brief Starts over on Map, nothing is searched until compute is called.
+     */
+    void initialize(const GridMap& Map, int Start, int Goal) {
+        map = &Map;
+        start = Start;
+        goal = Goal;
+        km = 0;
+        g.assign(Map.state.size(), Infinity);
+        rhs.assign(Map.state.size(), Infinity);
+        queuedKey.assign(Map.state.size(), Key(0, 0));
+        inQueue.assign(Map.state.size(), 0);
+        que = decltype(que)();
+        rhs[goal] = 0;
+        push(goal);
+    }
+    /**
+     * @brief Cost of going from From into the neighbor To, Infinity if one of them is an obstacle.
+     */
+    int cost(int From, int To) const {
+        if (map->state[From] == Obstacle || map->state[To] == Obstacle)
+            return Infinity;
+        return map->cost[To];
+    }
+    Key key(int Node) const {
+        int Best = min(g[Node], rhs[Node]);
+        return Key(min(Infinity, Best + ManhattanHeuristic{ map->width }(start, Node) + km), Best);
+    }
+    /**
+     * @brief Recomputes rhs of Node from its neighbors and puts it in the queue if it isn't consistent.
+     */
+    void update_vertex(int Node) {
+        if (Node != goal) {
+            int Best = Infinity;
+            for (pair<int, int> NodeAndWeight : map->adjacent(Node))
+                Best = min(Best, cost(Node, NodeAndWeight.first) + g[NodeAndWeight.first]);
+            rhs[Node] = min(Best, Infinity);
+        }
+        inQueue[Node] = 0;
+        if (g[Node] != rhs[Node])
+            push(Node);
+    }
+    /**
+     * @brief Has to be called for every cell whose state or cost changed in the map, then compute repairs the search.
+     */
+    void update_cell(int Node) {
+        update_vertex(Node);
+        for (pair<int, int> NodeAndWeight : map->adjacent(Node))
+            update_vertex(NodeAndWeight.first);
+    }
+    /**
+     * @brief Moves the start (the goal stays), for an agent that walks along the path.
+     */
+    void move_start(int NewStart) {
+        km += ManhattanHeuristic{ map->width }(start, NewStart);
+        start = NewStart;
+    }
+    /**
+     * @brief Expands nodes until the start is consistent and nothing in the queue can change it anymore.
+     *
+     * @return int 1 if there is a path from start to goal.
+     */
+    int compute() {
+        touched.clear();
+        while (true) {
+            skip_old();
+            if (que.empty() || (!(que.top().first < key(start)) && rhs[start] == g[start]))
+                break;
+            Key Old = que.top().first;
+            int Node = que.top().second;
+            Key New = key(Node);
+            touched.push_back(Node);
+            if (Old < New) {
+                push(Node);
+            }
+            else if (g[Node] > rhs[Node]) {
+                g[Node] = rhs[Node];
+                inQueue[Node] = 0;
+                for (pair<int, int> NodeAndWeight : map->adjacent(Node))
+                    update_vertex(NodeAndWeight.first);
+            }
+            else {
+                g[Node] = Infinity;
+                update_vertex(Node);
+                for (pair<int, int> NodeAndWeight : map->adjacent(Node))
+                    update_vertex(NodeAndWeight.first);
+            }
+        }
+        return rhs[start] < Infinity;
+    }
+    /**
+     * @brief The current path, like GetPath gives it (without the start, with the goal). Empty if there is none.
+     */
+    vector<int> path() const {
+        vector<int> path;
+        if (rhs[start] >= Infinity)
+            return path;
+        for (int Node = start; Node != goal && path.size() < g.size(); ) {
+            int Best = Infinity, Next = -1;
+            for (pair<int, int> NodeAndWeight : map->adjacent(Node)) {
+                int Through = cost(Node, NodeAndWeight.first) + g[NodeAndWeight.first];
+                if (Through < Best) {
+                    Best = Through;
+                    Next = NodeAndWeight.first;
+                }
+            }
+            if (Next == -1)
+                return vector<int>();
+            path.push_back(Next);
+            Node = Next;
+        }
+        return path;
+    }
+
+private:
+    void push(int Node) {
+        queuedKey[Node] = key(Node);
+        inQueue[Node] = 1;
+        que.push(make_pair(queuedKey[Node], Node));
+    }
+    // Drops the entries of nodes that left the queue or got a new key since
+    void skip_old() {
+        while (!que.empty() && (!inQueue[que.top().second] || queuedKey[que.top().second] != que.top().first))
+            que.pop();
+    }
+};
+const int DStarLite::Infinity;
+
+struct World {
+    int worldHeight;
+    int worldWidth;
+    int cellWidth;
+    int startIndex = -1, endIndex = -1;
+    sf::Vector2u windowSize;
+    std::vector<sw::Line> grid;
+    GridGraph graph;
+    IndexedHeap<4> heap; // Kept between runs by DijkstraIndexed
+    DepthFirstStack<GridGraph> stack; // Kept between runs by DepthFirstSearchIterative
+    DepthFirstStack<DiagonalGridGraph> diagonalStack; // Same for the 8 directions
+    DStarLite planner; // Follows the edits after a D* Lite run
+    bool replanning = false;
+    HierarchicalGrid hierarchy; // Built on the first HPA* run, then kept up to date with the edits
+    LandmarkTable landmarks; // Built on the first ALT run, kept until the map or the movement changes
+    int landmarksMovement = -1; // Movement the landmarks were built for, -1 when they have to be built again
+    FlowField flow; // Follows the edits after a flow field run
+    bool flowing = false;
+    ComponentIndex components; // Tells at once when the end is walled off, follows every edit
+    SearchContext searchContext; // BFS, Dijkstra and A* write here instead of the map, a new query just starts a new epoch
+    vector<int> searchPath; // Path of the last query on searchContext
+    bool searchShown = false; // The last run was on searchContext, its cells are drawn from there
+    bool mapMarked = false; // The last run wrote Visited, Path and distances into the map
+    int mode = 0;
+    int movement = 0; // 0: 4 directions, 1: 8 directions, 2: 8 directions cutting corners
+
+    bool once = true;
+
+    // Text
+    sf::Text text;
+
+
+    World(sf::RenderWindow& window, sf::Font& arialFont) {
+        // settings
+        windowSize = window.getSize();
+        cellWidth = 20;
+        worldWidth = windowSize.x / cellWidth;
+        worldHeight = windowSize.y / cellWidth;
+
+        // Nodes, the edges are implicit in the grid
+        graph.resize(worldWidth, worldHeight);
+        components.build(graph);
+
+        // Font and text settinggs
+        text.setFont(arialFont); // font is a sf::Font
+        text.setString("BFS");
+        text.setCharacterSize(24); // in pixels, not points!
+        text.setFillColor(sf::Color::Black);
+        text.setStyle(sf::Text::Bold | sf::Text::Underlined);
+
+        // grid
+        sw::Line line;
+        line.setColor(sf::Color::Black);
+
+        // Horizontal
+        for (int y = 1; y < worldHeight; y++) {
+            line.setPoint(0, sf::Vector2f(0.0f, y * cellWidth));
+            line.setPoint(1, sf::Vector2f(windowSize.x, y * cellWidth));
+            grid.push_back(line);
+        }
+        // Vertical
+        for (int x = 1; x < worldWidth; x++) {
+            line.setPoint(0, sf::Vector2f(x * cellWidth, 0.0f));
+            line.setPoint(1, sf::Vector2f(x * cellWidth, windowSize.y));
+            grid.push_back(line);
+        }
+    }
+
+    void update(sf::RenderWindow& window, sf::Event& event) {
+        // Checks for event that chanegs the nodes status
+        updateNodes(window, event);
+
+        // Check if mode is changed
+        if (event.type == sf::Event::KeyPressed)
+            if (event.key.code == sf::Keyboard::LAlt || event.key.code == sf::Keyboard::RAlt) {
+                mode++;
+                mode %= 16;
+                updateText();
+            }
+        // 'D' switches between 4 directions, 8 directions and 8 directions cutting corners
+        if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::D) {
+            movement = (movement + 1) % 3;
+            updateText();
+        }
+        // Check if Enter is pressed and run the algo for the corresponding mode
+        if (event.type == sf::Event::KeyReleased)
+            if (event.key.code == sf::Keyboard::Enter && startIndex != -1 && endIndex != -1) {
+                // Only the marks of the last search go away, the map stays as it is
+                if (!once)
+                    clearSearch();
+                DiagonalGridGraph diagonal(graph, movement == 2);
+                // A walled off end has no path, no search is started for it
+                bool Reachable = components.connected(startIndex, endIndex);
+                switch (Reachable ? mode : -1) {
+                case -1:
+                    break;
+                case 4:
+                    JumpPointSearch(graph, startIndex, endIndex);
+                    break;
+                case 9:
+                    planner.initialize(graph, startIndex, endIndex);
+                    replan();
+                    break;
+                case 10:
+                    runHierarchical();
                     break;
-                case 1:
-                    text.setString("Dijkstra");
+                case 12:
+                    flow.build(graph, endIndex);
+                    showFlow();
                     break;
-                case 2:
-                    text.setString("DFS");
+                case 13:
+                case 14:
+                    ThetaStar(diagonal, startIndex, endIndex, mode == 14);
+                    if (graph.found)
+                        showPath(AnyAnglePath(diagonal, endIndex, startIndex));
                     break;
                 default:
+                    // The rest runs on any grid, 4 or 8 directions
+                    if (movement == 0)
+                        runSearch(graph, stack, ManhattanHeuristic{ worldWidth }, 1);
+                    else
+                        runSearch(diagonal, diagonalStack, OctileHeuristic{ worldWidth, DiagonalGridGraph::Straight, DiagonalGridGraph::Diagonal }, DiagonalGridGraph::Diagonal);
                     break;
                 }
+                replanning = Reachable && mode == 9;
+                flowing = Reachable && mode == 12;
+                mapMarked = !searchShown;
+
+                graph.state[startIndex] = Start;
+                graph.state[endIndex] = End;
+                if (graph.found)
+                    GetPath(graph, endIndex, startIndex);
+                once = false;
             }
-        // Check if Enter is pressed and run the algo for the corresponding mode
-        if (event.type == sf::Event::KeyReleased)
-            if (event.key.code == sf::Keyboard::Enter && startIndex != -1 && endIndex != -1) {
-                if (once) {
-                    switch (mode) {
-                    case 0:
-                        BreadthFirstSearch(graph, startIndex, endIndex);
-                        break;
-                    case 1:
-                        DijkstraQ(graph, startIndex, endIndex);
-                        break;
-                    case 2:
-                        DepthFirstSearch(graph, startIndex, endIndex);
-                        break;
-                    default:
-                        break;
-                    }
+    }
+
+    /**
+     * @brief Runs the search of the current mode on searchGraph, the GridGraph itself or its 8-connected view.
+     *
+     * @param heuristic Estimate for A* that fits the grid (Manhattan or octile).
+     * @param LongestStep Weight of the most expensive step into a cell that costs 1.
+     */
+    template <typename GraphType, typename Heuristic>
+    void runSearch(GraphType& searchGraph, DepthFirstStack<GraphType>& searchStack, Heuristic heuristic, int LongestStep) {
+        switch (mode) {
+        case 0:
+            SearchBFS(searchGraph, searchContext, startIndex, endIndex);
+            searchShown = true;
+            break;
+        case 1:
+            SearchDijkstra(searchGraph, searchContext, startIndex, endIndex);
+            searchShown = true;
+            break;
+        case 2:
+            DepthFirstSearchIterative(searchGraph, startIndex, endIndex, searchStack);
+            break;
+        case 3:
+            SearchAStar(searchGraph, searchContext, startIndex, endIndex, heuristic);
+            searchShown = true;
+            break;
+        case 5:
+            DijkstraDial(searchGraph, startIndex, endIndex, LongestStep * *max_element(graph.cost.begin(), graph.cost.end()));
+            break;
+        case 6:
+            DijkstraIndexed(searchGraph, startIndex, endIndex, heap);
+            break;
+        case 7:
+            BidirectionalBFS(searchGraph, startIndex, endIndex);
+            break;
+        case 8:
+            BidirectionalDijkstra(searchGraph, startIndex, endIndex);
+            break;
+        case 11:
+            if (landmarksMovement != movement) {
+                landmarks.build(searchGraph, AvoidLandmarks(searchGraph, 8));
+                landmarksMovement = movement;
+            }
+            AStar(searchGraph, startIndex, endIndex, LandmarkHeuristic{ &landmarks });
+            break;
+        case 15: {
+            // Whatever it has after 2 ms, with how far from the shortest it may be
+            double Bound = AnytimeAStar(searchGraph, startIndex, endIndex, heuristic, chrono::steady_clock::now() + chrono::milliseconds(2));
+            updateText();
+            if (searchGraph.found) {
+                string Text = to_string(Bound);
+                text.setString(text.getString() + ", at most " + Text.substr(0, Text.find('.') + 3) + "x the shortest");
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        if (searchShown)
+            searchPath = GetSearchPath(searchContext, endIndex, startIndex);
+    }
+
+    /**
+     * @brief Shows the name of the current mode, and the movement if it isn't 4 directions.
+     */
+    void updateText() {
+        switch (mode) {
+        case 0:
+            text.setString("BFS");
+            break;
+        case 1:
+            text.setString("Dijkstra");
+            break;
+        case 2:
+            text.setString("DFS");
+            break;
+        case 3:
+            text.setString("A*");
+            break;
+        case 4:
+            text.setString("JPS");
+            break;
+        case 5:
+            text.setString("Dijkstra (buckets)");
+            break;
+        case 6:
+            text.setString("Dijkstra (4-ary heap)");
+            break;
+        case 7:
+            text.setString("Bidirectional BFS");
+            break;
+        case 8:
+            text.setString("Bidirectional Dijkstra");
+            break;
+        case 9:
+            text.setString("D* Lite");
+            break;
+        case 10:
+            text.setString("HPA*");
+            break;
+        case 11:
+            text.setString("A* (landmarks)");
+            break;
+        case 12:
+            text.setString("Flow field");
+            break;
+        case 13:
+            text.setString("Theta*");
+            break;
+        case 14:
+            text.setString("Lazy Theta*");
+            break;
+        case 15:
+            text.setString("ARA*");
+            break;
+        default:
+            break;
+        }
+        // JPS, D* Lite, HPA* and the flow field always go in 4 directions
+        if (movement > 0 && mode != 4 && mode != 9 && mode != 10 && mode != 12)
+            text.setString(text.getString() + (movement == 1 ? " (8 directions)" : " (8 directions, cutting corners)"));
+    }
 
-                    graph.state[startIndex] = Start;
-                    graph.state[endIndex] = End;
-                    if (graph.found)
-                        GetPath(graph, endIndex, startIndex);
-                }
-                once = false;
+    /**
+     * @brief Removes the Visited and Path cells and the distances of the last search, so the next one can run on the same map without restarting.
+     * Only the searches that write into the map need the whole map cleared, after the ones on searchContext only their path is dropped.
+     */
+    void clearSearch() {
+        searchShown = false;
+        searchPath.clear();
+        if (mapMarked)
+            for (int i = 0; i < worldWidth * worldHeight; i++) {
+                if (graph.state[i] == Visited || graph.state[i] == Path)
+                    graph.state[i] = graph.cost[i] > 1 ? Junction : Empty;
+                graph.distance[i] = 0x7FFFFFFF;
             }
+        graph.found = 0;
+        // Searches can paint over them
+        graph.state[startIndex] = Start;
+        graph.state[endIndex] = End;
+    }
+
+    /**
+     * @brief Lets D* Lite repair its search and shows the nodes it went through and the new path.
+     */
+    void replan() {
+        planner.compute();
+        for (int Node : planner.touched)
+            if (graph.state[Node] != Obstacle && graph.state[Node] != Start && graph.state[Node] != End)
+                graph.state[Node] = Visited;
+        showPath(planner.path());
+    }
+
+    /**
+     * @brief Shows the path (as GetPath gives it) of a search that doesn't fill graph.parent, the parents are set along it for the GetPath after a run.
+     */
+    void showPath(const vector<int>& path) {
+        int Parent = startIndex, Distance = 0;
+        for (int Node : path) {
+            Distance += graph.cost[Node];
+            graph.parent[Node] = Parent;
+            graph.distance[Node] = Distance;
+            Parent = Node;
+            if (Node != endIndex)
+                graph.state[Node] = Path;
+        }
+        graph.found = !path.empty();
+    }
+
+    /**
+     * @brief Lets the flow field follow the last edit and shows the cells it changed and the way from the start along it.
+     */
+    void showFlow() {
+        for (int Node : flow.touched)
+            if (graph.state[Node] != Obstacle && graph.state[Node] != Start && graph.state[Node] != End)
+                graph.state[Node] = Visited;
+        vector<int> path;
+        for (int Node = flow.next(startIndex); Node != -1; Node = flow.next(Node))
+            path.push_back(Node);
+        showPath(path);
+    }
+
+    /**
+     * @brief Finds the path with HPA*, the waypoints of the abstract path are shown as visited.
+     */
+    void runHierarchical() {
+        if (hierarchy.clusters.empty())
+            hierarchy.build(graph, 8);
+        vector<int> waypoints = hierarchy.abstract_path(startIndex, endIndex), path;
+        for (int Node : waypoints)
+            graph.state[Node] = Visited;
+        for (size_t Segment = 0; Segment + 1 < waypoints.size(); Segment++) {
+            vector<int> part = hierarchy.refine(waypoints, Segment);
+            path.insert(path.end(), part.begin(), part.end());
+        }
+        showPath(path);
     }
 
     void updateNodes(sf::RenderWindow& window, sf::Event& event) {
@@ -296,6 +4239,8 @@ struct World {
         int i = (mousePos.y / cellWidth) * worldWidth + (mousePos.x / cellWidth);
 
         if (mousePos.x > 0 && mousePos.y > 0 && mousePos.x < windowSize.x && mousePos.y < windowSize.y) {
+            bool WasObstacle = graph.state[i] == Obstacle;
+            int OldCost = graph.cost[i];
             if (sf::Mouse::isButtonPressed(sf::Mouse::Right)) {
                 graph.update_node_weight(i, 2);
                 if (graph.state[i] == Start)
@@ -348,6 +4293,34 @@ struct World {
                     endIndex = -1;
                 graph.state[i] = Empty;
             }
+
+            bool Edited = WasObstacle != (graph.state[i] == Obstacle) || OldCost != graph.cost[i];
+            if (WasObstacle != (graph.state[i] == Obstacle))
+                components.update_cell(graph, i);
+            if (!hierarchy.clusters.empty() && Edited)
+                hierarchy.update_cell(i);
+            if (Edited)
+                landmarksMovement = -1;
+
+            // D* Lite keeps up with the edits and with the start moving along, until the end is moved
+            if (replanning && (startIndex == -1 || endIndex != planner.goal))
+                replanning = false;
+            if (replanning && (Edited || startIndex != planner.start)) {
+                clearSearch();
+                if (Edited)
+                    planner.update_cell(i);
+                if (startIndex != planner.start)
+                    planner.move_start(startIndex);
+                replan();
+            }
+            // So does the flow field, towards the same end
+            if (flowing && endIndex != flow.goal)
+                flowing = false;
+            if (flowing && startIndex != -1 && Edited) {
+                clearSearch();
+                flow.update_cell(i);
+                showFlow();
+            }
         }
     }
 
@@ -365,7 +4338,10 @@ struct World {
                 int i = y * worldWidth + x;
                 rect.setPosition(sf::Vector2f(x * cellWidth, y * cellWidth));
 
-                switch (graph.state[i]) {
+                NodeState State = graph.state[i];
+                if (searchShown && (State == Empty || State == Junction) && searchContext.reached(i))
+                    State = Visited;
+                switch (State) {
                 case Visited:
                     rect.setFillColor(sf::Color(128, 128, 128, 100));
                     window.draw(rect);
@@ -394,6 +4370,12 @@ struct World {
                     break;
                 }
             }
+        rect.setFillColor(sf::Color::Yellow);
+        for (int Node : searchPath)
+            if (graph.state[Node] == Empty || graph.state[Node] == Junction) {
+                rect.setPosition(sf::Vector2f(Node % worldWidth * cellWidth, Node / worldWidth * cellWidth));
+                window.draw(rect);
+            }
 
         // Draw text
         window.draw(text);
@@ -401,13 +4383,1036 @@ struct World {
 
 };
 
-int main() {
+/**
+ * @brief Times the serial and parallel whole map searches on a big random grid and prints the speedup for every thread count.
+ * Run the program with --benchmark to get here instead of the window.
+ */
+void RunBenchmark() {
+    const int Width = 2000, Height = 2000;
+    GridGraph map;
+    map.resize(Width, Height);
+    srand(1);
+    for (int i = 0; i < Width * Height; i++) {
+        int Roll = rand() % 10;
+        if (Roll == 0)
+            map.state[i] = Obstacle;
+        else if (Roll < 3) {
+            map.update_node_weight(i, 2);
+            map.state[i] = Junction;
+        }
+    }
+    const int Source = (Height / 2) * Width + Width / 2;
+    map.state[Source] = Start;
+    typedef chrono::steady_clock Clock;
+    std::cout << Width << "x" << Height << " grid, 10% obstacles, 20% junctions" << std::endl;
+
+    GridGraph serial = map;
+    Clock::time_point Begin = Clock::now();
+    DijkstraQ(serial, Source, -1);
+    double SerialTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    std::cout << "DijkstraQ: " << SerialTime << " ms" << std::endl;
+
+    GridGraph radix = map;
+    Begin = Clock::now();
+    DijkstraRadix(radix, Source, -1);
+    std::cout << "DijkstraRadix: " << chrono::duration<double, milli>(Clock::now() - Begin).count() << " ms"
+              << (radix.distance == serial.distance ? "" : " (DISTANCES DIFFER)") << std::endl;
+
+    // One long query, JPS only queues the cells where its jumps stop. Junctions stop the jumps, so it runs on a map without them too
+    GridGraph sparse;
+    sparse.resize(Width, Height);
+    for (int i = 0; i < Width * Height; i++)
+        if (rand() % 100 == 0)
+            sparse.state[i] = Obstacle;
+    sparse.state[Source] = Start;
+    const int Target = (Height / 2 + 700) * Width + Width / 2 - 800;
+    for (GridGraph* grid : { &map, &sparse }) {
+        GridGraph plain = *grid, jumps = *grid;
+        plain.state[Target] = jumps.state[Target] = Empty;
+        Begin = Clock::now();
+        DijkstraQ(plain, Source, Target);
+        double PlainTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+        Begin = Clock::now();
+        JumpPointSearch(jumps, Source, Target);
+        double JumpTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+        std::cout << (grid == &map ? "Same map" : "1% obstacles, no junctions") << ", DijkstraQ to one cell: " << PlainTime << " ms, "
+                  << count(plain.state.begin(), plain.state.end(), Visited) << " cells queued, JumpPointSearch: " << JumpTime << " ms, "
+                  << count(jumps.state.begin(), jumps.state.end(), Visited) << " cells queued"
+                  << (plain.distance[Target] == jumps.distance[Target] ? "" : " (DISTANCES DIFFER)") << std::endl;
+    }
+
+    GridGraph levels = map;
+    Begin = Clock::now();
+    BreadthFirstSearch(levels, Source, -1);
+    double LevelsTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    std::cout << "BreadthFirstSearch: " << LevelsTime << " ms" << std::endl;
+
+    int MaxThreads = max(1, (int)thread::hardware_concurrency());
+    for (int Threads = 1; ; Threads = min(Threads * 2, MaxThreads)) {
+        ThreadPool pool(Threads);
+        GridGraph parallel = map;
+        Begin = Clock::now();
+        DeltaStepping(parallel, Source, 2, pool);
+        double Time = chrono::duration<double, milli>(Clock::now() - Begin).count();
+        std::cout << "DeltaStepping, " << Threads << " threads: " << Time << " ms, speedup " << SerialTime / Time
+                  << (parallel.distance == serial.distance ? "" : " (DISTANCES DIFFER)") << std::endl;
+        parallel = map;
+        Begin = Clock::now();
+        ParallelBFS(parallel, Source, pool);
+        Time = chrono::duration<double, milli>(Clock::now() - Begin).count();
+        std::cout << "ParallelBFS, " << Threads << " threads: " << Time << " ms, speedup " << LevelsTime / Time
+                  << (parallel.distance == levels.distance ? "" : " (DISTANCES DIFFER)") << std::endl;
+        if (Threads == MaxThreads)
+            break;
+    }
+
+    // 16 x 16 distances around the middle, one pruned Dijkstra per source on all the threads against one Dijkstra per pair
+    vector<int> sources, targets;
+    while (targets.size() < 16) {
+        // An obstacle can't be reached, its row would search the whole map
+        int Cell = Source + (rand() % 201 - 100) * Width + rand() % 201 - 100;
+        if (map.state[Cell] != Obstacle)
+            (sources.size() < 16 ? sources : targets).push_back(Cell);
+    }
+    ThreadPool pool(MaxThreads);
+    Begin = Clock::now();
+    vector<int> table = DistanceTable(map, sources, targets, pool);
+    double TableTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    SearchContext single;
+    bool SameTable = true;
+    Begin = Clock::now();
+    for (size_t Row = 0; Row < sources.size(); Row++)
+        for (size_t Column = 0; Column < targets.size(); Column++) {
+            SearchDijkstra(map, single, sources[Row], targets[Column]);
+            SameTable = SameTable && single.get_distance(targets[Column]) == table[Row * targets.size() + Column];
+        }
+    double PairTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    std::cout << "DistanceTable 16 x 16, " << MaxThreads << " threads: " << TableTime << " ms, SearchDijkstra per pair: " << PairTime << " ms"
+              << (SameTable ? "" : " (DISTANCES DIFFER)") << std::endl;
+
+    // Flow field to the middle of the map, one Dijkstra against DeltaStepping and the directions on all the threads
+    FlowField serialFlow, parallelFlow;
+    Begin = Clock::now();
+    serialFlow.build(map, Source);
+    double FlowTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    Begin = Clock::now();
+    parallelFlow.build_parallel(map, Source, pool);
+    double ParallelFlowTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    std::cout << "FlowField::build: " << FlowTime << " ms, build_parallel, " << MaxThreads << " threads: " << ParallelFlowTime << " ms"
+              << (serialFlow.distance == parallelFlow.distance ? "" : " (DISTANCES DIFFER)") << std::endl;
+
+    // Whole map BFS on the bit planes against the byte per cell map
+    PackedGrid packed;
+    packed.build(map);
+    SearchContext grid, bits;
+    Begin = Clock::now();
+    SearchBFS(map, grid, Source, -1);
+    double GridTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    Begin = Clock::now();
+    PackedBFS(packed, bits, Source, -1);
+    double PackedTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    std::cout << "SearchBFS: " << GridTime << " ms, PackedBFS: " << PackedTime << " ms"
+              << (grid.distance == bits.distance ? "" : " (DISTANCES DIFFER)") << std::endl;
+    Begin = Clock::now();
+    SearchDijkstra(map, grid, Source, -1);
+    GridTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    Begin = Clock::now();
+    PackedDijkstra(packed, bits, Source, -1);
+    PackedTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    std::cout << "SearchDijkstra: " << GridTime << " ms, PackedDijkstra: " << PackedTime << " ms"
+              << (grid.distance == bits.distance ? "" : " (DISTANCES DIFFER)") << std::endl;
+
+    // Layers 64 cells at a time against the queue, on the same map with every cell costing 1
+    GridMap unit = map;
+    fill(unit.cost.begin(), unit.cost.end(), 1);
+    WavefrontGrid wave;
+    wave.build(unit);
+    vector<int> layers;
+    Begin = Clock::now();
+    SearchBFS(unit, grid, Source, -1);
+    GridTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    Begin = Clock::now();
+    WavefrontBFS(wave, Source, layers);
+    double WaveTime = chrono::duration<double, milli>(Clock::now() - Begin).count();
+    bool Same = true;
+    for (int Node = 0; Node < Width * Height; Node++)
+        Same = Same && grid.get_distance(Node) == layers[Node];
+    std::cout << "SearchBFS (every cell costs 1): " << GridTime << " ms, WavefrontBFS: " << WaveTime << " ms, speedup " << GridTime / WaveTime
+              << (Same ? "" : " (DISTANCES DIFFER)") << std::endl;
+}
+
+/**
+ * @brief Counts and prints the checks of RunTests that failed.
+ */
+struct TestReport {
+    int failures = 0;
+    void check(bool Passed, const string& What) {
+        if (!Passed) {
+            std::cout << "FAILED: " << What << std::endl;
+            failures++;
+        }
+    }
+};
+
+/**
+ * @brief Width x Height grid with about ObstaclePercent % obstacles and JunctionPercent % junctions, the same map for the same Seed.
+ */
+GridGraph RandomGrid(int Width, int Height, int ObstaclePercent, int JunctionPercent, unsigned Seed) {
+    GridGraph map;
+    map.resize(Width, Height);
+    srand(Seed);
+    for (int i = 0; i < Width * Height; i++) {
+        int Roll = rand() % 100;
+        if (Roll < ObstaclePercent)
+            map.state[i] = Obstacle;
+        else if (Roll < ObstaclePercent + JunctionPercent) {
+            map.update_node_weight(i, 2);
+            map.state[i] = Junction;
+        }
+    }
+    return map;
+}
+
+/**
+ * @brief The same grid as a Graph with adjacency lists, the edges in the order GridMap::adjacent hands them out.
+ */
+Graph GridToGraph(const GridMap& map) {
+    Graph graph;
+    graph.resize(map.width * map.height);
+    for (int Node = 0; Node < map.width * map.height; Node++) {
+        for (pair<int, int> NodeAndWeight : map.adjacent(Node))
+            graph.adj_weighted[Node].push_back({ NodeAndWeight.first, 1 });
+        graph.cost[Node] = map.cost[Node];
+        graph.state[Node] = map.state[Node];
+    }
+    return graph;
+}
+
+/**
+ * @brief True if Path (as GetPath gives it, without Source) steps from Source to EndNode over free neighboring cells, its cost goes to Cost.
+ *
+ * @param map A GridMap, or a DiagonalGridGraph for paths with diagonal steps.
+ */
+template <typename GridType>
+bool ValidGridPath(const GridType& map, int Source, int EndNode, const vector<int>& Path, int& Cost) {
+    Cost = 0;
+    int Node = Source;
+    for (int Next : Path) {
+        int Weight = -1;
+        for (pair<int, int> NodeAndWeight : map.adjacent(Node))
+            if (NodeAndWeight.first == Next)
+                Weight = NodeAndWeight.second;
+        if (Weight == -1 || map.state[Next] == Obstacle)
+            return false;
+        Cost += Weight;
+        Node = Next;
+    }
+    return Node == EndNode;
+}
+
+/**
+ * @brief BFS and Dijkstra give the same distances on the adjacency lists, the CSR arrays and the implicit grid.
+ */
+void TestCsrGraph(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 20; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 20, 20, Seed);
+        int Source = rand() % (30 * 20);
+        map.state[Source] = Start;
+        Graph lists = GridToGraph(map);
+        CsrGraph csr;
+        csr.build(lists);
+        Graph listsBFS = lists;
+        CsrGraph csrBFS = csr;
+        BreadthFirstSearch(listsBFS, Source, -1);
+        BreadthFirstSearch(csrBFS, Source, -1);
+        report.check(listsBFS.distance == csrBFS.distance, "BreadthFirstSearch on CsrGraph, seed " + to_string(Seed));
+        GridGraph grid = map;
+        DijkstraQ(lists, Source, -1);
+        DijkstraQ(csr, Source, -1);
+        DijkstraQ(grid, Source, -1);
+        report.check(lists.distance == csr.distance && csr.distance == grid.distance, "DijkstraQ on CsrGraph, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief JumpPointSearch finds the DijkstraQ distance on maps with obstacles and junctions, and once the cells between the jump points
+ * are filled in GetPath steps from the end to the start one neighboring cell at a time.
+ */
+void TestJumpPointSearch(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 20; Seed++) {
+        GridGraph map = RandomGrid(40, 30, 25, Seed % 2 ? 20 : 0, Seed);
+        for (int Query = 0; Query < 10; Query++) {
+            int Source = rand() % (40 * 30), EndNode = rand() % (40 * 30);
+            if (map.state[Source] == Obstacle || map.state[EndNode] == Obstacle || Source == EndNode)
+                continue;
+            GridGraph shortest = map, jumps = map;
+            shortest.state[Source] = jumps.state[Source] = Start;
+            DijkstraQ(shortest, Source, EndNode);
+            JumpPointSearch(jumps, Source, EndNode);
+            int Cost = 0;
+            bool Same = jumps.found == shortest.found;
+            if (Same && jumps.found)
+                Same = jumps.distance[EndNode] == shortest.distance[EndNode]
+                    && ValidGridPath(map, Source, EndNode, GetPath(jumps, EndNode, Source), Cost) && Cost == jumps.distance[EndNode];
+            report.check(Same, "JumpPointSearch, seed " + to_string(Seed) + ", query " + to_string(Query));
+        }
+    }
+}
+
+/**
+ * @brief DijkstraDial gives the distance and parent of DijkstraQ for every node, on the 4-connected grid and with 8 directions.
+ */
+void TestDijkstraDial(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 20; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 20, 20, Seed);
+        int Source = rand() % (30 * 20);
+        map.state[Source] = Start;
+        GridGraph queue = map, buckets = map;
+        DijkstraQ(queue, Source, -1);
+        DijkstraDial(buckets, Source, -1, 2);
+        report.check(queue.distance == buckets.distance && queue.parent == buckets.parent, "DijkstraDial, seed " + to_string(Seed));
+        queue = map;
+        buckets = map;
+        DiagonalGridGraph queueView(queue, Seed % 2 == 0), bucketsView(buckets, Seed % 2 == 0);
+        DijkstraQ(queueView, Source, -1);
+        DijkstraDial(bucketsView, Source, -1, 2 * DiagonalGridGraph::Diagonal);
+        report.check(queue.distance == buckets.distance && queue.parent == buckets.parent, "DijkstraDial with 8 directions, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief DijkstraRadix gives the distances of DijkstraQ, with 32 bit keys on the grid and with 64 bit keys on costs that add up past 2^31.
+ */
+void TestRadixHeap(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 20; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 20, 20, Seed);
+        int Source = rand() % (30 * 20);
+        map.state[Source] = Start;
+        GridGraph queue = map, radix = map;
+        DijkstraQ(queue, Source, -1);
+        DijkstraRadix(radix, Source, -1);
+        report.check(queue.distance == radix.distance, "DijkstraRadix, seed " + to_string(Seed));
+
+        // Every cell costs 10^8 times as much, the far cells are more than 2^31 away
+        const int Scale = 100000000;
+        CsrGraph expensive;
+        expensive.build(GridToGraph(map));
+        for (int Node = 0; Node < 30 * 20; Node++)
+            expensive.update_node_weight(Node, map.cost[Node] * Scale);
+        LongDistanceGraph<CsrGraph> wide(expensive);
+        DijkstraRadix(wide, Source, -1);
+        bool Same = true, PastInt = false;
+        for (int Node = 0; Node < 30 * 20; Node++) {
+            long long Expected = queue.distance[Node] == 0x7FFFFFFF ? 0x7FFFFFFFFFFFFFFFLL : (long long)queue.distance[Node] * Scale;
+            Same = Same && wide.distance[Node] == Expected;
+            PastInt = PastInt || (Expected != 0x7FFFFFFFFFFFFFFFLL && Expected > 0x7FFFFFFF);
+        }
+        report.check(Same && PastInt, "DijkstraRadix with 64 bit distances, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief DijkstraIndexed gives the distance and parent of DijkstraQ for every node, with one IndexedHeap kept across all the queries
+ * like the World does (queries that stop at the end leave nodes in it, and the map size changes now and then), on the 4-connected
+ * grid and with 8 directions. After every query no node may be left with a position.
+ */
+void TestIndexedHeap(TestReport& report) {
+    IndexedHeap<4> heap;
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        int Width = Seed <= 5 ? 30 : 25, Height = 20;
+        GridGraph map = RandomGrid(Width, Height, 20, 20, Seed);
+        for (int Query = 0; Query < 10; Query++) {
+            int Source = rand() % (Width * Height), EndNode = Query % 3 == 0 ? -1 : rand() % (Width * Height);
+            if (map.state[Source] == Obstacle)
+                continue;
+            string Name = ", seed " + to_string(Seed) + ", query " + to_string(Query);
+            GridGraph queue = map, indexed = map;
+            queue.state[Source] = indexed.state[Source] = Start;
+            bool Diagonal = Query % 2 == 1;
+            if (Diagonal) {
+                DiagonalGridGraph queueView(queue), indexedView(indexed);
+                DijkstraQ(queueView, Source, EndNode);
+                DijkstraIndexed(indexedView, Source, EndNode, heap);
+            }
+            else {
+                DijkstraQ(queue, Source, EndNode);
+                DijkstraIndexed(indexed, Source, EndNode, heap);
+            }
+            report.check(queue.distance == indexed.distance && queue.parent == indexed.parent && queue.found == indexed.found,
+                         string(Diagonal ? "DijkstraIndexed with 8 directions" : "DijkstraIndexed") + Name);
+            report.check(heap.empty() && count(heap.position.begin(), heap.position.end(), -1) == Width * Height, "IndexedHeap left empty" + Name);
+        }
+    }
+}
+
+/**
+ * @brief BidirectionalBFS finds a path with as few steps as BreadthFirstSearch (the same distance where every cell costs 1) and
+ * BidirectionalDijkstra the DijkstraQ distance, on the 4-connected grid and with 8 directions, with junctions, and nothing for an end
+ * that is walled in. GetPath has to step from the end back to the start over neighboring cells at the cost of distance[EndNode].
+ */
+void TestBidirectional(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 20; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 20, Seed % 2 ? 20 : 0, Seed);
+        bool Diagonal = Seed % 4 >= 2;
+        for (int Query = 0; Query < 10; Query++) {
+            int Source = rand() % (30 * 20), EndNode = rand() % (30 * 20);
+            if (map.state[Source] == Obstacle || map.state[EndNode] == Obstacle || Source == EndNode)
+                continue;
+            GridGraph query = map;
+            if (Query == 0) {
+                // Walled in from all 8 sides
+                if (abs(Source % 30 - EndNode % 30) <= 1 && abs(Source / 30 - EndNode / 30) <= 1)
+                    continue;
+                for (int dy = -1; dy <= 1; dy++)
+                    for (int dx = -1; dx <= 1; dx++) {
+                        int x = EndNode % 30 + dx, y = EndNode / 30 + dy;
+                        if ((dx || dy) && x >= 0 && y >= 0 && x < 30 && y < 20)
+                            query.state[y * 30 + x] = Obstacle;
+                    }
+            }
+            query.state[Source] = Start;
+            query.state[EndNode] = End;
+            string Name = string(Diagonal ? " with 8 directions" : "") + ", seed " + to_string(Seed) + ", query " + to_string(Query);
+            GridGraph levels = query, shortest = query, twoLevels = query, twoShortest = query, steps = query;
+            DiagonalGridGraph levelsView(levels), shortestView(shortest), twoLevelsView(twoLevels), twoShortestView(twoShortest), stepsView(steps);
+            vector<int> levelsPath, twoLevelsPath, twoShortestPath;
+            if (Diagonal) {
+                BreadthFirstSearch(levelsView, Source, EndNode);
+                DijkstraQ(shortestView, Source, EndNode);
+                BidirectionalBFS(twoLevelsView, Source, EndNode);
+                BidirectionalDijkstra(twoShortestView, Source, EndNode);
+            }
+            else {
+                BreadthFirstSearch(levels, Source, EndNode);
+                DijkstraQ(shortest, Source, EndNode);
+                BidirectionalBFS(twoLevels, Source, EndNode);
+                BidirectionalDijkstra(twoShortest, Source, EndNode);
+            }
+            if (levels.found)
+                levelsPath = GetPath(levels, EndNode, Source);
+            if (twoLevels.found)
+                twoLevelsPath = GetPath(twoLevels, EndNode, Source);
+            if (twoShortest.found)
+                twoShortestPath = GetPath(twoShortest, EndNode, Source);
+            auto Valid = [&](const GridGraph& graph, const vector<int>& path) {
+                int Cost = 0;
+                bool Chain = Diagonal ? ValidGridPath(stepsView, Source, EndNode, path, Cost) : ValidGridPath(steps, Source, EndNode, path, Cost);
+                return Chain && Cost == graph.distance[EndNode];
+            };
+            // With junctions two paths with the fewest steps may cost different amounts, without them they cost the same
+            report.check(twoLevels.found == levels.found && (!levels.found || (twoLevelsPath.size() == levelsPath.size() && Valid(twoLevels, twoLevelsPath)
+                                                                               && (Seed % 2 || twoLevels.distance[EndNode] == levels.distance[EndNode]))),
+                         "BidirectionalBFS" + Name);
+            report.check(twoShortest.found == shortest.found
+                         && (!shortest.found || (twoShortest.distance[EndNode] == shortest.distance[EndNode] && Valid(twoShortest, twoShortestPath))),
+                         "BidirectionalDijkstra" + Name);
+            if (Query == 0)
+                report.check(!twoLevels.found && !twoShortest.found, "Bidirectional searches to a walled in end" + Name);
+        }
+    }
+}
+
+/**
+ * @brief DepthFirstSearchIterative visits the cells DepthFirstSearch visits and leaves the same parent and found, and it gets through
+ * a winding corridor of more than 200000 cells that would overflow the thread stack with recursion.
+ */
+void TestDepthFirstSearch(TestReport& report) {
+    DepthFirstStack<GridGraph> stack;
+    for (unsigned Seed = 1; Seed <= 20; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 30, 20, Seed);
+        for (int Query = 0; Query < 5; Query++) {
+            int Source = rand() % (30 * 20), EndNode = Query == 0 ? -1 : rand() % (30 * 20);
+            if (map.state[Source] == Obstacle)
+                continue;
+            GridGraph recursive = map, iterative = map;
+            recursive.state[Source] = iterative.state[Source] = Start;
+            DepthFirstSearch(recursive, Source, EndNode);
+            DepthFirstSearchIterative(iterative, Source, EndNode, stack);
+            report.check(recursive.parent == iterative.parent && recursive.found == iterative.found && recursive.state == iterative.state,
+                         "DepthFirstSearchIterative, seed " + to_string(Seed) + ", query " + to_string(Query));
+        }
+    }
+
+    // Every other row is a wall with a gap at alternating ends, so the only way through is one cell wide and goes through every free cell
+    const int Width = 1001, Height = 401;
+    GridGraph snake;
+    snake.resize(Width, Height);
+    int Corridor = Width * Height;
+    for (int y = 1; y < Height; y += 2)
+        for (int x = 0; x < Width; x++)
+            if (x != (y / 2 % 2 == 0 ? Width - 1 : 0)) {
+                snake.state[y * Width + x] = Obstacle;
+                Corridor--;
+            }
+    const int Source = 0, EndNode = (Height - 1) * Width + ((Height - 2) / 2 % 2 == 0 ? 0 : Width - 1);
+    snake.state[Source] = Start;
+    DepthFirstSearchIterative(snake, Source, EndNode, stack);
+    int Steps = 0;
+    for (int Node = EndNode; snake.found && Node != Source && Steps < Corridor; Node = snake.parent[Node])
+        Steps++;
+    report.check(Corridor > 200000 && snake.found && Steps == Corridor - 1, "DepthFirstSearchIterative through a corridor of " + to_string(Corridor) + " cells");
+}
+
+/**
+ * @brief ParallelBFS and DeltaStepping give the distances and parents of BreadthFirstSearch and DijkstraQ, with one thread and with several.
+ */
+void TestParallelSearches(TestReport& report) {
+    ThreadPool one(1), three(3);
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        GridGraph map = RandomGrid(40, 30, 25, 20, Seed);
+        int Source = rand() % (40 * 30);
+        map.state[Source] = Start;
+        CsrGraph csr;
+        csr.build(GridToGraph(map));
+        GridGraph levels = map, shortest = map;
+        BreadthFirstSearch(levels, Source, -1);
+        DijkstraQ(shortest, Source, -1);
+        for (ThreadPool* pool : { &one, &three }) {
+            string Name = to_string(pool->size()) + " threads, seed " + to_string(Seed);
+            GridGraph grid = map;
+            CsrGraph arrays = csr;
+            ParallelBFS(grid, Source, *pool);
+            ParallelBFS(arrays, Source, *pool);
+            report.check(grid.distance == levels.distance && grid.parent == levels.parent && arrays.distance == levels.distance,
+                         "ParallelBFS, " + Name);
+            grid = map;
+            arrays = csr;
+            DeltaStepping(grid, Source, 2, *pool);
+            DeltaStepping(arrays, Source, 1, *pool);
+            report.check(grid.distance == shortest.distance && grid.parent == shortest.parent && arrays.distance == shortest.distance,
+                         "DeltaStepping, " + Name);
+        }
+    }
+}
+
+/**
+ * @brief Queries one after another on the same SearchContext give the distances of the engines that write into a fresh graph.
+ */
+void TestSearchContext(TestReport& report) {
+    SearchContext context;
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 20, 20, Seed);
+        for (int Query = 0; Query < 5; Query++) {
+            int Source = rand() % (30 * 20), EndNode = rand() % (30 * 20);
+            if (map.state[Source] == Obstacle || Source == EndNode)
+                continue;
+            string Name = ", seed " + to_string(Seed) + ", query " + to_string(Query);
+            GridGraph levels = map, shortest = map, diagonal = map;
+            levels.state[Source] = shortest.state[Source] = diagonal.state[Source] = Start;
+            BreadthFirstSearch(levels, Source, -1);
+            DijkstraQ(shortest, Source, -1);
+            DiagonalGridGraph view(diagonal);
+            DijkstraQ(view, Source, -1);
+            bool Same = true;
+            SearchBFS(map, context, Source, -1);
+            for (int Node = 0; Node < 30 * 20; Node++)
+                Same = Same && context.get_distance(Node) == levels.distance[Node];
+            report.check(Same, "SearchBFS" + Name);
+            Same = true;
+            SearchDijkstra(map, context, Source, -1);
+            for (int Node = 0; Node < 30 * 20; Node++)
+                Same = Same && context.get_distance(Node) == shortest.distance[Node];
+            report.check(Same, "SearchDijkstra" + Name);
+            SearchAStar(map, context, Source, EndNode, ManhattanHeuristic{ 30 });
+            report.check(context.get_distance(EndNode) == shortest.distance[EndNode], "SearchAStar" + Name);
+            SearchAStar(view, context, Source, EndNode, OctileHeuristic{ 30, DiagonalGridGraph::Straight, DiagonalGridGraph::Diagonal });
+            report.check(context.get_distance(EndNode) == diagonal.distance[EndNode], "SearchAStar with 8 directions" + Name);
+        }
+    }
+}
+
+/**
+ * @brief AnswerQueries on several threads sharing one map gives the paths of SearchAStar run one query after another, and leaves the map as it was.
+ */
+void TestAnswerQueries(TestReport& report) {
+    ThreadPool pool(3);
+    SearchContext context;
+    for (unsigned Seed = 1; Seed <= 5; Seed++) {
+        GridGraph map = RandomGrid(60, 40, 25, 20, Seed);
+        vector<pair<int, int>> queries;
+        for (int Query = 0; Query < 200; Query++)
+            queries.push_back({ rand() % (60 * 40), rand() % (60 * 40) });
+        vector<NodeState> Before = map.state;
+        vector<vector<int>> paths = AnswerQueries(map, queries, pool);
+        bool Same = true;
+        for (size_t Query = 0; Query < queries.size(); Query++) {
+            vector<int> path;
+            if (SearchAStar(map, context, queries[Query].first, queries[Query].second, ManhattanHeuristic{ 60 }))
+                path = GetSearchPath(context, queries[Query].second, queries[Query].first);
+            Same = Same && paths[Query] == path;
+        }
+        report.check(Same && map.state == Before, "AnswerQueries, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief D* Lite following a start that walks along its path while cells change around it keeps the distance DijkstraQ finds from scratch.
+ */
+void TestDStarLite(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 20, 20, Seed);
+        int Source = rand() % (30 * 20), Goal = rand() % (30 * 20);
+        map.state[Source] = map.state[Goal] = Empty;
+        DStarLite planner;
+        planner.initialize(map, Source, Goal);
+        planner.compute();
+        bool Same = true;
+        for (int Step = 0; Step < 30; Step++) {
+            GridGraph fresh = map;
+            fresh.state[planner.start] = Start;
+            DijkstraQ(fresh, planner.start, -1);
+            int Expected = fresh.distance[Goal] == 0x7FFFFFFF ? DStarLite::Infinity : fresh.distance[Goal];
+            Same = Same && planner.rhs[planner.start] == Expected;
+            // A step along the path, then a few cells change
+            vector<int> path = planner.path();
+            if (!path.empty() && path[0] != Goal)
+                planner.move_start(path[0]);
+            for (int Edit = 0; Edit < 3; Edit++) {
+                int Cell = rand() % (30 * 20);
+                if (Cell == planner.start || Cell == Goal)
+                    continue;
+                if (rand() % 2)
+                    map.state[Cell] = map.state[Cell] == Obstacle ? Empty : Obstacle;
+                else
+                    map.update_node_weight(Cell, map.cost[Cell] == 1 ? 2 : 1);
+                planner.update_cell(Cell);
+            }
+            planner.compute();
+        }
+        report.check(Same, "DStarLite with a moving start, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief HPA* finds a path whenever DijkstraQ does, never a shorter one than DijkstraQ, also after cells changed and the clusters were repaired.
+ */
+void TestHierarchicalGrid(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        GridGraph map = RandomGrid(45, 30, 25, 20, Seed);
+        HierarchicalGrid hierarchy;
+        hierarchy.build(map, 8);
+        bool Same = true;
+        for (int Query = 0; Query < 20; Query++) {
+            int Source = rand() % (45 * 30), EndNode = rand() % (45 * 30);
+            if (map.state[Source] == Obstacle || map.state[EndNode] == Obstacle || Source == EndNode)
+                continue;
+            GridGraph fresh = map;
+            fresh.state[Source] = Start;
+            DijkstraQ(fresh, Source, -1);
+            vector<int> path = hierarchy.find_path(Source, EndNode);
+            int Cost;
+            if (fresh.distance[EndNode] == 0x7FFFFFFF)
+                Same = Same && path.empty();
+            else
+                Same = Same && ValidGridPath(map, Source, EndNode, path, Cost) && Cost >= fresh.distance[EndNode];
+            // Some cells change before the next query
+            for (int Edit = 0; Edit < 5; Edit++) {
+                int Cell = rand() % (45 * 30);
+                if (rand() % 2)
+                    map.state[Cell] = map.state[Cell] == Obstacle ? Empty : Obstacle;
+                else
+                    map.update_node_weight(Cell, map.cost[Cell] == 1 ? 2 : 1);
+                hierarchy.update_cell(Cell);
+            }
+        }
+        report.check(Same, "HierarchicalGrid::find_path, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief Contraction Hierarchies give the distances of DijkstraQ and unpack into valid paths, also after a save and load.
+ * A file that was cut short or has broken sizes, offsets or edges must not load.
+ */
+void TestContractionHierarchy(TestReport& report) {
+    const string FileName = "ContractionTest.ch";
+    for (unsigned Seed = 1; Seed <= 5; Seed++) {
+        GridGraph map = RandomGrid(30, 20, 20, 20, Seed);
+        ContractionHierarchy built, loaded;
+        built.build(map);
+        report.check(built.save(FileName) && loaded.load(FileName), "ContractionHierarchy save and load, seed " + to_string(Seed));
+        ContractionSearch search;
+        bool Same = true;
+        for (int Query = 0; Query < 20; Query++) {
+            int Source = rand() % (30 * 20), EndNode = rand() % (30 * 20);
+            if (map.state[Source] == Obstacle || map.state[EndNode] == Obstacle || Source == EndNode)
+                continue;
+            GridGraph fresh = map;
+            fresh.state[Source] = Start;
+            DijkstraQ(fresh, Source, -1);
+            for (ContractionHierarchy* hierarchy : { &built, &loaded }) {
+                int Found = hierarchy->query(search, Source, EndNode), Distance = search.distance, Cost = -1;
+                vector<int> path = hierarchy->unpack(search, Source, EndNode);
+                Same = Same && Found == (fresh.distance[EndNode] != 0x7FFFFFFF) && (!Found || Distance == fresh.distance[EndNode])
+                    && (!Found || (ValidGridPath(map, Source, EndNode, path, Cost) && Cost == Distance));
+            }
+        }
+        report.check(Same, "ContractionHierarchy::query, seed " + to_string(Seed));
+
+        // The file is the magic, then every array as a 64 bit size and its items: rank, up_offsets, up, down_offsets, down
+        ifstream in(FileName, ios::binary);
+        string File((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        in.close();
+        const size_t NodeCount = built.rank.size(), UpOffsets = 4 + 8 + NodeCount * 4 + 8, Up = UpOffsets + (NodeCount + 1) * 4 + 8;
+        size_t Shortcut = 0;
+        while (Shortcut < built.up.size() && built.up[Shortcut].middle == -1)
+            Shortcut++;
+        auto Overwrite = [](string& Bytes, size_t At, int Value) {
+            copy((const char*)&Value, (const char*)&Value + 4, Bytes.begin() + At);
+        };
+        vector<pair<string, string>> broken;
+        broken.push_back({ "cut short", File.substr(0, File.size() - 5) });
+        broken.push_back({ "huge size", File });
+        fill(broken.back().second.begin() + 4, broken.back().second.begin() + 12, (char)0xFF);
+        broken.push_back({ "offsets past the edges", File });
+        int Past = (int)built.up.size() + 1;
+        Overwrite(broken.back().second, UpOffsets + NodeCount * 4, Past);
+        broken.push_back({ "edge to a missing node", File });
+        int Missing = (int)NodeCount;
+        Overwrite(broken.back().second, Up, Missing);
+        if (Shortcut < built.up.size()) {
+            broken.push_back({ "shortcut over a missing node", File });
+            Overwrite(broken.back().second, Up + Shortcut * sizeof(ContractionHierarchy::Edge) + 8, Missing);
+        }
+        for (const pair<string, string>& Case : broken) {
+            ofstream out(FileName, ios::binary);
+            out.write(Case.second.data(), Case.second.size());
+            out.close();
+            report.check(!loaded.load(FileName) && loaded.rank.empty(), "ContractionHierarchy::load of a file with " + Case.first + ", seed " + to_string(Seed));
+        }
+    }
+    remove(FileName.c_str());
+}
+
+/**
+ * @brief Landmarks picked by FarthestLandmarks and AvoidLandmarks are free and different, their bounds never overestimate and A* with them
+ * finds the distance of DijkstraQ, in 4 and 8 directions.
+ */
+void TestLandmarks(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 6; Seed++) {
+        GridGraph map = RandomGrid(40, 30, 25, 20, Seed);
+        for (int Avoid = 0; Avoid < 2; Avoid++) {
+            string Name = string(Avoid ? "AvoidLandmarks" : "FarthestLandmarks") + (Seed % 2 ? " in 8 directions" : "") + ", seed " + to_string(Seed);
+            GridGraph shortest = map, viewed = map;
+            DiagonalGridGraph view(viewed);
+            vector<int> picked = Seed % 2 ? (Avoid ? AvoidLandmarks(view, 8) : FarthestLandmarks(view, 8)) : (Avoid ? AvoidLandmarks(map, 8) : FarthestLandmarks(map, 8));
+            bool Free = picked.size() == 8;
+            for (size_t k = 0; k < picked.size(); k++)
+                Free = Free && map.state[picked[k]] != Obstacle && count(picked.begin(), picked.end(), picked[k]) == 1;
+            report.check(Free, Name + " picks 8 different free cells");
+            LandmarkTable table;
+            if (Seed % 2)
+                table.build(view, picked);
+            else
+                table.build(map, picked);
+            int Source = rand() % (40 * 30), EndNode = rand() % (40 * 30);
+            if (map.state[Source] == Obstacle || Source == EndNode)
+                continue;
+            shortest.state[Source] = viewed.state[Source] = Start;
+            bool Below = true;
+            if (Seed % 2) {
+                DijkstraQ(view, Source, -1);
+                for (int Node = 0; Node < 40 * 30; Node++)
+                    Below = Below && (viewed.distance[Node] == 0x7FFFFFFF || table.lower_bound(Source, Node) <= viewed.distance[Node]);
+                DiagonalGridGraph guided(shortest);
+                AStar(guided, Source, EndNode, LandmarkHeuristic{ &table });
+                Below = Below && shortest.distance[EndNode] == viewed.distance[EndNode];
+            }
+            else {
+                DijkstraQ(shortest, Source, -1);
+                for (int Node = 0; Node < 40 * 30; Node++)
+                    Below = Below && (shortest.distance[Node] == 0x7FFFFFFF || table.lower_bound(Source, Node) <= shortest.distance[Node]);
+                SearchContext context;
+                SearchAStar(map, context, Source, EndNode, LandmarkHeuristic{ &table });
+                Below = Below && context.get_distance(EndNode) == shortest.distance[EndNode];
+            }
+            report.check(Below, Name + " bounds");
+        }
+    }
+}
+
+/**
+ * @brief Every entry of DistanceTable is the distance DijkstraQ gives, also with a target asked for twice and with unreachable targets.
+ */
+void TestDistanceTable(TestReport& report) {
+    ThreadPool pool(3);
+    for (unsigned Seed = 1; Seed <= 6; Seed++) {
+        GridGraph map = RandomGrid(40, 30, 25, 20, Seed);
+        vector<int> sources, targets;
+        for (int i = 0; i < 6; i++) {
+            sources.push_back(rand() % (40 * 30));
+            targets.push_back(rand() % (40 * 30));
+        }
+        targets.push_back(targets[0]);
+        CsrGraph csr;
+        csr.build(GridToGraph(map));
+        vector<int> grid = DistanceTable(map, sources, targets, pool), arrays = DistanceTable(csr, sources, targets, pool);
+        bool Same = grid == arrays;
+        for (size_t Row = 0; Row < sources.size(); Row++) {
+            if (map.state[sources[Row]] == Obstacle)
+                continue;
+            GridGraph fresh = map;
+            fresh.state[sources[Row]] = Start;
+            DijkstraQ(fresh, sources[Row], -1);
+            for (size_t Column = 0; Column < targets.size(); Column++) {
+                int Target = targets[Column];
+                int Expected = Target == sources[Row] ? 0 : map.state[Target] == Obstacle ? 0x7FFFFFFF : fresh.distance[Target];
+                Same = Same && grid[Row * targets.size() + Column] == Expected;
+            }
+        }
+        report.check(Same, "DistanceTable, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief FlowField::build_parallel gives the field of build, the field repaired by update_cell after edits is the one build makes from
+ * scratch, and following next from any cell costs its distance.
+ */
+void TestFlowField(TestReport& report) {
+    ThreadPool pool(3);
+    for (unsigned Seed = 1; Seed <= 6; Seed++) {
+        GridGraph map = RandomGrid(40, 30, 25, 20, Seed);
+        int Goal = rand() % (40 * 30);
+        map.state[Goal] = Empty;
+        FlowField serial, parallel, repaired;
+        serial.build(map, Goal);
+        parallel.build_parallel(map, Goal, pool);
+        report.check(serial.distance == parallel.distance && serial.direction == parallel.direction, "FlowField::build_parallel, seed " + to_string(Seed));
+        repaired.build(map, Goal);
+        for (int Edit = 0; Edit < 20; Edit++) {
+            int Cell = rand() % (40 * 30);
+            if (Cell == Goal)
+                continue;
+            if (rand() % 2)
+                map.state[Cell] = map.state[Cell] == Obstacle ? Empty : Obstacle;
+            else
+                map.update_node_weight(Cell, map.cost[Cell] == 1 ? 2 : 1);
+            repaired.update_cell(Cell);
+        }
+        serial.build(map, Goal);
+        bool Same = serial.distance == repaired.distance;
+        for (int Node = 0; Node < 40 * 30; Node++) {
+            if (repaired.distance[Node] == 0x7FFFFFFF)
+                continue;
+            int Cost = 0, Steps = 0;
+            for (int Cell = repaired.next(Node); Cell != -1 && Steps <= 40 * 30; Cell = repaired.next(Cell), Steps++)
+                Cost += map.cost[Cell];
+            Same = Same && Cost == repaired.distance[Node];
+        }
+        report.check(Same, "FlowField::update_cell, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief PackedBFS and PackedDijkstra give the distances and parents of SearchBFS and SearchDijkstra, also after cells were changed on both
+ * grids, and a cost that doesn't fit in four bits is refused without touching the cell next to it.
+ */
+void TestPackedGrid(TestReport& report) {
+    SearchContext plain, packed;
+    for (unsigned Seed = 1; Seed <= 6; Seed++) {
+        GridGraph map = RandomGrid(45, 30, 25, 20, Seed);
+        PackedGrid grid;
+        report.check(grid.build(map), "PackedGrid::build, seed " + to_string(Seed));
+        for (int Edit = 0; Edit < 20; Edit++) {
+            int Cell = rand() % (45 * 30), Weight = 1 + rand() % 15;
+            map.state[Cell] = map.state[Cell] == Obstacle ? Empty : Obstacle;
+            grid.set_obstacle(Cell, map.state[Cell] == Obstacle);
+            map.update_node_weight(Cell, Weight);
+            grid.update_node_weight(Cell, Weight);
+        }
+        int Cell = rand() % (45 * 30 - 1), Next = grid.node_cost(Cell + 1);
+        report.check(!grid.update_node_weight(Cell, 16) && !grid.update_node_weight(Cell, 0) && grid.node_cost(Cell) == map.cost[Cell] && grid.node_cost(Cell + 1) == Next,
+                     "PackedGrid::update_node_weight out of range, seed " + to_string(Seed));
+        int Source = rand() % (45 * 30);
+        map.state[Source] = Empty;
+        grid.set_obstacle(Source, false);
+        SearchBFS(map, plain, Source, -1);
+        PackedBFS(grid, packed, Source, -1);
+        bool Same = true;
+        for (int Node = 0; Node < 45 * 30; Node++)
+            Same = Same && plain.get_distance(Node) == packed.get_distance(Node) && (!plain.reached(Node) || plain.parent[Node] == packed.parent[Node]);
+        report.check(Same, "PackedBFS, seed " + to_string(Seed));
+        SearchDijkstra(map, plain, Source, -1);
+        PackedDijkstra(grid, packed, Source, -1);
+        for (int Node = 0; Node < 45 * 30; Node++)
+            Same = Same && plain.get_distance(Node) == packed.get_distance(Node) && (!plain.reached(Node) || plain.parent[Node] == packed.parent[Node]);
+        report.check(Same, "PackedDijkstra, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief WavefrontBFS gives the layers of SearchBFS on maps where every cell costs 1, including open maps where the wave runs into all
+ * four edges and sizes that aren't multiples of the 8x8 tiles. Worth running in a build with AddressSanitizer, with and without AVX2.
+ */
+void TestWavefrontBFS(TestReport& report) {
+    SearchContext context;
+    const int Sizes[5][2] = { { 1, 1 }, { 8, 8 }, { 13, 5 }, { 64, 9 }, { 70, 41 } };
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        int Width = Sizes[Seed % 5][0], Height = Sizes[Seed % 5][1];
+        GridGraph map = RandomGrid(Width, Height, Seed <= 5 ? 0 : 20, 0, Seed);
+        WavefrontGrid grid;
+        grid.build(map);
+        int Source = rand() % (Width * Height);
+        map.state[Source] = Empty;
+        grid.set_obstacle(Source, false);
+        vector<int> layers;
+        WavefrontBFS(grid, Source, layers);
+        SearchBFS(map, context, Source, -1);
+        bool Same = true;
+        for (int Node = 0; Node < Width * Height; Node++)
+            Same = Same && layers[Node] == context.get_distance(Node);
+        report.check(Same, "WavefrontBFS on " + to_string(Width) + "x" + to_string(Height) + ", seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief Theta* and Lazy Theta* reach the end whenever A* does on the 8-connected grid, over free cells only, and their paths are
+ * never longer than the octile one A* finds.
+ */
+void TestThetaStar(TestReport& report) {
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        GridGraph map = RandomGrid(40, 30, 25, 20, Seed);
+        bool CutCorners = Seed % 2 == 0;
+        for (int Query = 0; Query < 10; Query++) {
+            int Source = rand() % (40 * 30), EndNode = rand() % (40 * 30);
+            if (map.state[Source] == Obstacle || map.state[EndNode] == Obstacle || Source == EndNode)
+                continue;
+            GridGraph octile = map;
+            octile.state[Source] = Start;
+            DiagonalGridGraph steps(octile, CutCorners);
+            AStar(steps, Source, EndNode, OctileHeuristic{ 40, DiagonalGridGraph::Straight, DiagonalGridGraph::Diagonal });
+            for (bool Lazy : { false, true }) {
+                GridGraph anyAngle = map;
+                anyAngle.state[Source] = Start;
+                DiagonalGridGraph lines(anyAngle, CutCorners);
+                ThetaStar(lines, Source, EndNode, Lazy);
+                bool Clear = true;
+                if (anyAngle.found)
+                    for (int Node : AnyAnglePath(lines, EndNode, Source))
+                        Clear = Clear && map.state[Node] != Obstacle;
+                report.check(anyAngle.found == octile.found && Clear && (!octile.found || anyAngle.distance[EndNode] <= octile.distance[EndNode]),
+                             string(Lazy ? "Lazy Theta*" : "Theta*") + ", seed " + to_string(Seed) + ", query " + to_string(Query));
+            }
+        }
+    }
+}
+
+/**
+ * @brief ComponentIndex kept up to date with update_cell while random cells are turned into obstacles and back agrees with an index
+ * built from scratch on every pair of cells after every edit. The sizes have to match the labels too: every label counts its cells,
+ * so the pieces a cut gives a new label to are taken out of the old one, and there are as many nonempty parts as in the fresh index.
+ */
+void TestComponentIndex(TestReport& report) {
+    const int Width = 16, Height = 12, NodeCount = Width * Height;
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        GridGraph map = RandomGrid(Width, Height, 30, 10, Seed);
+        ComponentIndex kept;
+        kept.build(map);
+        bool Same = true, Sizes = true;
+        for (int Edit = 0; Edit < 150 && Same && Sizes; Edit++) {
+            int Node = rand() % NodeCount;
+            map.state[Node] = map.state[Node] == Obstacle ? Empty : Obstacle;
+            kept.update_cell(map, Node);
+            ComponentIndex fresh;
+            fresh.build(map);
+            for (int From = 0; From < NodeCount; From++)
+                for (int To = 0; To < NodeCount; To++)
+                    Same = Same && kept.connected(From, To) == fresh.connected(From, To);
+            vector<int> cells(kept.size.size(), 0);
+            for (int Cell = 0; Cell < NodeCount; Cell++) {
+                if ((kept.label[Cell] == -1) != (map.state[Cell] == Obstacle) || kept.label[Cell] >= (int)cells.size())
+                    Sizes = false;
+                else if (kept.label[Cell] != -1)
+                    cells[kept.label[Cell]]++;
+            }
+            Sizes = Sizes && cells == kept.size
+                && count_if(kept.size.begin(), kept.size.end(), [](int Size) { return Size > 0; }) == (int)fresh.size.size();
+        }
+        report.check(Same, "ComponentIndex::connected after edits, seed " + to_string(Seed));
+        report.check(Sizes, "ComponentIndex labels and sizes after edits, seed " + to_string(Seed));
+    }
+}
+
+/**
+ * @brief AnytimeAStar with time to finish ends with the Dijkstra distance and a bound of exactly 1 (also when Source is EndNode),
+ * and when it is stopped after a few expansions the path it has is within the bound it returns. That path can be cheaper than
+ * graph.distance[EndNode], the parents along it may have improved in the round that was cut short.
+ */
+void TestAnytimeAStar(TestReport& report) {
+    const chrono::steady_clock::time_point Never = chrono::steady_clock::now() + chrono::hours(1);
+    for (unsigned Seed = 1; Seed <= 10; Seed++) {
+        GridGraph map = RandomGrid(40, 30, 25, 20, Seed);
+        for (int Query = 0; Query < 10; Query++) {
+            int Source = rand() % (40 * 30), EndNode = Query == 0 ? Source : rand() % (40 * 30);
+            if (map.state[Source] == Obstacle || map.state[EndNode] == Obstacle)
+                continue;
+            string Name = ", seed " + to_string(Seed) + ", query " + to_string(Query);
+            GridGraph shortest = map, anytime = map;
+            shortest.state[Source] = anytime.state[Source] = Start;
+            DijkstraQ(shortest, Source, -1);
+            bool Reachable = shortest.distance[EndNode] != 0x7FFFFFFF;
+            double Bound = AnytimeAStar(anytime, Source, EndNode, ManhattanHeuristic{ 40 }, Never);
+            report.check(anytime.found == Reachable && (!Reachable || (Bound == 1 && anytime.distance[EndNode] == shortest.distance[EndNode])),
+                         "AnytimeAStar" + Name);
+            for (long long MaxExpansions : { 0LL, 20LL, 200LL }) {
+                GridGraph stopped = map;
+                stopped.state[Source] = Start;
+                Bound = AnytimeAStar(stopped, Source, EndNode, ManhattanHeuristic{ 40 }, Never, MaxExpansions);
+                int Cost = 0;
+                bool Within = !stopped.found || (Reachable && Bound >= 1 && Bound <= 3
+                                                 && ValidGridPath(map, Source, EndNode, GetPath(stopped, EndNode, Source), Cost)
+                                                 && Cost <= stopped.distance[EndNode] && Cost <= Bound * shortest.distance[EndNode] + 1e-9);
+                report.check(Within, "AnytimeAStar stopped after " + to_string(MaxExpansions) + " expansions" + Name);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Checks the engines against each other on small random maps, run the program with --test to get here.
+ *
+ * @return Number of failed checks.
+ */
+int RunTests() {
+    TestReport report;
+    TestCsrGraph(report);
+    TestJumpPointSearch(report);
+    TestDijkstraDial(report);
+    TestRadixHeap(report);
+    TestIndexedHeap(report);
+    TestBidirectional(report);
+    TestDepthFirstSearch(report);
+    TestParallelSearches(report);
+    TestSearchContext(report);
+    TestAnswerQueries(report);
+    TestDStarLite(report);
+    TestHierarchicalGrid(report);
+    TestContractionHierarchy(report);
+    TestLandmarks(report);
+    TestDistanceTable(report);
+    TestFlowField(report);
+    TestPackedGrid(report);
+    TestWavefrontBFS(report);
+    TestThetaStar(report);
+    TestComponentIndex(report);
+    TestAnytimeAStar(report);
+    std::cout << (report.failures ? to_string(report.failures) + " checks failed" : "All checks passed") << std::endl;
+    return report.failures;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--test")
+        return RunTests() == 0 ? 0 : 1;
+    if (argc > 1 && string(argv[1]) == "--benchmark") {
+        RunBenchmark();
+        return 0;
+    }
+
     std::cout << "Welcome to Our Project \n" << "How to use: \n"
         << "'S': Set a starting node,     'E': Set an ending node\n"
         << "'R': Restart,                 'Enter' : Run(only after setting starting and ending points)\n"
-        << "'Left Mouse': Add obstacle,   'Right Mouse': Add Junction(Adds weight of 2 to all edges connected to the cell)\n"
+        << "'Left Mouse': Add obstacle,   'Right Mouse': Add Junction(Going into the cell costs 2)\n"
         << "'Shift': Remove Node\n"
-        << "'Alt': Switch Mode" << std::endl;
+        << "'Alt': Switch Mode,           'D': 4/8 directions" << std::endl;
     sf::RenderWindow window(sf::VideoMode(1280, 720), "EA Project", sf::Style::Default);
 
     sf::Font arialFont;